@@ -177,6 +177,12 @@ namespace HCUBE
 
         bool hasAnyMove(uchar b[8][8],int color);
 
+        /**
+         * isQuiet: Returns true if color has a move and none of its moves
+         * is a capture, so a search that has reached its depth stops here
+         */
+        bool isQuiet(uchar b[8][8],int color);
+
         int getWinner(uchar b[8][8]);
 
         int getWinner(uchar b[8][8],int colorToMove);
@@ -197,6 +203,61 @@ namespace HCUBE
 		string gameLogToPDN();
 	};
 
+    /**
+     *  The CheckersLeafBatch gathers leaf boards during a search so the
+     *  substrate can rate them all with one FastLayeredNetwork::updateBatch()
+     *  call, which reads the weights once per batch instead of once per
+     *  board.  A search adds the boards of a group of leaves (for example
+     *  the quiet replies at the last ply), calls evaluate(), and reads each
+     *  board's output back by the index addBoard() returned.
+     *
+     *  Boards are put on the input layer the same way
+     *  CheckersExperiment::evaluateLeafHyperNEAT does.  The outputs are not
+     *  rounded.
+     */
+    class CheckersLeafBatch
+    {
+    protected:
+        int inputWidth,inputHeight;
+        int numBoards;
+        int numOutputValues;
+        vector<CheckersNEATDatatype> inputValues;
+        vector<CheckersNEATDatatype> outputValues;
+
+    public:
+        CheckersLeafBatch(int _inputWidth=8,int _inputHeight=8);
+
+        /**
+         * clear: Removes every board from the batch
+         */
+        void clear();
+
+        /**
+         * addBoard: Adds b to the batch and returns its index
+         */
+        int addBoard(uchar b[8][8]);
+
+        /**
+         * evaluate: Runs every board in the batch through network.  The
+         * network must have one input layer of inputWidth*inputHeight nodes.
+         */
+        void evaluate(NEAT::FastLayeredNetwork<CheckersNEATDatatype> *network);
+
+        inline int getNumBoards()
+        {
+            return numBoards;
+        }
+
+        /**
+         * getOutput: Returns the first node of the last layer for the board
+         * at index
+         */
+        inline CheckersNEATDatatype getOutput(int index)
+        {
+            return outputValues[index*numOutputValues];
+        }
+    };
+
     class CheckersBoardState
     {
     public:
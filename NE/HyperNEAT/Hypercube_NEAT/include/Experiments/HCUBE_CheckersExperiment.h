@@ -50,6 +50,14 @@ namespace HCUBE
 
         int handCodedType;
 
+        /**
+         * leafBatch rates the quiet replies at the last ply together, and
+         * batchedLeafOutput points at the rating of the leaf that
+         * evaluateLeafHyperNEAT is about to see, or is NULL
+         */
+        CheckersLeafBatch leafBatch;
+        const CheckersNEATDatatype *batchedLeafOutput;
+
         int DEBUG_USE_HANDCODED_EVALUATION;
         int DEBUG_USE_HYPERNEAT_EVALUATION;
         CheckersCachedBoard tmpboard;
@@ -91,6 +99,36 @@ namespace HCUBE
 
         virtual pair<CheckersNEATDatatype,int> evaluateLeafHyperNEAT(uchar b[8][8]);
 
+        /**
+         * findCachedEvaluation: Looks b up in the board evaluation cache.
+         * Leaves b loaded in tmpboard either way.
+         */
+        bool findCachedEvaluation(uchar b[8][8],CheckersNEATDatatype &output);
+
+        /**
+         * isBatchingLeaves: Returns true if the leaves are rated by the
+         * substrate as evaluateLeafHyperNEAT() rates them here, so that
+         * batchLeafEvaluations() can rate them ahead of time
+         */
+        virtual inline bool isBatchingLeaves()
+        {
+            return true;
+        }
+
+        /**
+         * batchLeafEvaluations: Rates every white move from b that leaves
+         * black a quiet leaf in one batch.  leafIndices[a] is the index in
+         * leafOutputs of the rating after move a, or -1 if that board is
+         * left to evaluatemax().
+         */
+        void batchLeafEvaluations(
+            uchar b[8][8],
+            int firstMove,
+            int numMoves,
+            vector<int> &leafIndices,
+            vector<CheckersNEATDatatype> &leafOutputs
+        );
+
         virtual pair<CheckersNEATDatatype,int> evaluatemax(
             uchar b[8][8],
             CheckersNEATDatatype parentBeta,
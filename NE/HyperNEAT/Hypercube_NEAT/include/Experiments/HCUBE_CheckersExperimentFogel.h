@@ -39,6 +39,12 @@ namespace HCUBE
 
         virtual pair<CheckersNEATDatatype,int> evaluateLeafHyperNEAT(uchar b[8][8]);
 
+        //Leaves are rated by this experiment's own network
+        virtual inline bool isBatchingLeaves()
+        {
+            return false;
+        }
+
         virtual CheckersNEATDatatype getSpatialInput(uchar b[8][8],int x,int y,int sizex,int sizey);
 
         virtual Experiment* clone();
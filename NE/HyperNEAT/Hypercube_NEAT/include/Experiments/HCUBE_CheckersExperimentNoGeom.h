@@ -39,6 +39,12 @@ namespace HCUBE
 			uchar b[8][8]
 		);
 
+        //Leaves are rated by this experiment's own network
+        virtual inline bool isBatchingLeaves()
+        {
+            return false;
+        }
+
 #if 0
         virtual double evaluateLeafHyperNEAT(uchar b[8][8]);
 #endif
@@ -146,18 +146,23 @@ namespace HCUBE
         for(int currentByte=0;currentByte<BYTES_TO_CHECK;currentByte++)
         {
             substrate.getNetwork()->reinitialize();
-            for(int a=0;a<1024;a++)
+
+            //The window is the 1024 bytes before this one, wrapping around
+            //to the end of the file
+            float *inputs = substrate.getInputLayer(0).row(0);
+            int readStart = currentByte-1024;
+            if(readStart<0)
+            {
+                memcpy(inputs,rawdataNormalized+readStart+fileSize,sizeof(float)*(-readStart));
+                memcpy(inputs-readStart,rawdataNormalized,sizeof(float)*(1024+readStart));
+            }
+            else
             {
-                int readIndex = ((currentByte-1024)+a);
-                if(readIndex<0)
-                {
-                    readIndex += fileSize;
-                }
-                substrate.setValue( Node(a,0,0), rawdataNormalized[readIndex] );
+                memcpy(inputs,rawdataNormalized+readStart,sizeof(float)*1024);
             }
             substrate.getNetwork()->dummyActivation();
             substrate.getNetwork()->update();
-            float answer = substrate.getValue( Node(0,0,1) );
+            float answer = substrate.getOutputLayer(1)(0,0);
             char answerChar = (char)(max(-128.0,min(127.0,answer*128.0)));
 
             difference += abs(int(answerChar)-int(rawdata[currentByte]));
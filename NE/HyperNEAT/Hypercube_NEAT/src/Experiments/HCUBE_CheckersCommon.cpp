@@ -949,6 +949,35 @@ namespace HCUBE
         return false;
     }
 
+    bool CheckersCommon::isQuiet(uchar b[8][8],int color)
+    {
+        bool foundMove=false;
+
+        for (int x=0;x<8;x++)
+        {
+            for (int y=(x%2);y<8;y+=2)
+            {
+                if ( (b[x][y]&color) )
+                {
+                    if ( (b[x][y]&(BLACK|KING)) )
+                    {
+                        //Black regular pieces move in the +y direction
+                        if (hasJump(b,color,x,y,1,1) || hasJump(b,color,x,y,-1,1)) return false;
+                        foundMove = foundMove || hasMove(b,color,x,y,1,1) || hasMove(b,color,x,y,-1,1);
+                    }
+
+                    if ( (b[x][y]&(WHITE|KING)) )
+                    {
+                        //White regular pieces move in the -y direction
+                        if (hasJump(b,color,x,y,1,-1) || hasJump(b,color,x,y,-1,-1)) return false;
+                        foundMove = foundMove || hasMove(b,color,x,y,1,-1) || hasMove(b,color,x,y,-1,-1);
+                    }
+                }
+            }
+        }
+        return foundMove;
+    }
+
     int CheckersCommon::getWinner(uchar b[8][8])
     {
         if (!(NUM_WHITE_PIECES(b)))
@@ -1068,6 +1097,91 @@ namespace HCUBE
         return output;
     }
 
+    CheckersLeafBatch::CheckersLeafBatch(int _inputWidth,int _inputHeight)
+        :
+    inputWidth(_inputWidth),
+        inputHeight(_inputHeight),
+        numBoards(0),
+        numOutputValues(0)
+    {
+    }
+
+    void CheckersLeafBatch::clear()
+    {
+        numBoards=0;
+        inputValues.clear();
+    }
+
+    int CheckersLeafBatch::addBoard(uchar b[8][8])
+    {
+        inputValues.resize((numBoards+1)*inputWidth*inputHeight,0.0);
+        CheckersNEATDatatype *boardValues = &inputValues[numBoards*inputWidth*inputHeight];
+
+        for (int y=0;y<inputHeight;y++)
+        {
+            for (int x=0;x<inputWidth;x++)
+            {
+                if ( (x+y)%2==1 ) //ignore empty squares.
+                    continue;
+
+                CheckersNEATDatatype value = 0.0;
+
+                if ( (b[x][y]&WHITE) )
+                {
+                    if ( (b[x][y]&KING) )
+                    {
+                        value = -0.75;
+                    }
+                    else if ( (b[x][y]&MAN) )
+                    {
+                        value = -0.5;
+                    }
+                    else
+                    {
+                        throw CREATE_LOCATEDEXCEPTION_INFO("Could not determine piece type (man/king)!");
+                    }
+                }
+                else if ( (b[x][y]&BLACK) )
+                {
+                    if ( (b[x][y]&KING) )
+                    {
+                        value = 0.75;
+                    }
+                    else if ( (b[x][y]&MAN) )
+                    {
+                        value = 0.5;
+                    }
+                    else
+                    {
+                        throw CREATE_LOCATEDEXCEPTION_INFO("Could not determine piece type (man/king)!");
+                    }
+                }
+
+                boardValues[y*inputWidth+x] = value;
+            }
+        }
+
+        numBoards++;
+        return numBoards-1;
+    }
+
+    void CheckersLeafBatch::evaluate(NEAT::FastLayeredNetwork<CheckersNEATDatatype> *network)
+    {
+        if (network->getNumInputValues()!=inputWidth*inputHeight)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("The network's input layer doesn't match the board!");
+        }
+
+        numOutputValues = network->getNumOutputValues();
+        if (!numBoards || !numOutputValues)
+        {
+            return;
+        }
+
+        outputValues.resize(numBoards*numOutputValues);
+        network->updateBatch(numBoards,&inputValues[0],&outputValues[0]);
+    }
+
     int CheckersCommon::gridToIndex(int x,int y)
     {
 #if 0 //old way
@@ -100,6 +100,7 @@ namespace HCUBE
     Experiment(_experimentName,_threadID),
         currentSubstrateIndex(0),
         from(255,255),
+        batchedLeafOutput(NULL),
         DEBUG_USE_HANDCODED_EVALUATION(0),
         DEBUG_USE_HYPERNEAT_EVALUATION(0),
         chanceToMakeSecondBestMove(0.0),
@@ -1116,89 +1117,79 @@ namespace HCUBE
         CheckersNEATDatatype output;
 
 #if DEBUG_USE_BOARD_EVALUATION_CACHE
-        tmpboard.loadBoard(b);
-        ushort hashVal = tmpboard.getShortHash();
-
-        BoardCacheList::iterator bIterator =
-            boardEvaluationCaches[currentSubstrateIndex][hashVal].begin();
-        BoardCacheList::iterator bEnd =
-            boardEvaluationCaches[currentSubstrateIndex][hashVal].end();
-
-        for (;bIterator != bEnd;bIterator++)
+        if (!findCachedEvaluation(b,output))
+#endif
         {
-            if (bIterator->first == tmpboard)
+            if (batchedLeafOutput)
             {
-                //We have a match!
-                break;
+                //Rated along with the rest of its batch
+                output = *batchedLeafOutput;
             }
-        }
-
-        if (bIterator != bEnd)
-        {
-            output = bIterator->second;
-        }
-        else
-#endif
-        {
-
-            substrate->getNetwork()->reinitialize();
-            substrate->getNetwork()->dummyActivation();
-
-            for (int y=0;y<numNodesY[0];y++)
+            else
             {
-                for (int x=0;x<numNodesX[0];x++)
-                {
-                    if ( (x+y)%2==1 ) //ignore empty squares.
-                        continue;
-
-                    int boardx = x;
-                    int boardy = y;
-
-                    //cout << boardx << ',' << boardy << ": " << b[boardx][boardy] << endl;
+                //Consecutive leaves differ by a few squares, so setInputValue
+                //only pushes those through the network's accumulator
+                substrate->getNetwork()->dummyActivation();
 
-                    if ( (b[boardx][boardy]&WHITE) )
+                for (int y=0;y<numNodesY[0];y++)
+                {
+                    for (int x=0;x<numNodesX[0];x++)
                     {
-                        //cout << "FOUND WHITE\n";
-                        if ( (b[boardx][boardy]&KING) )
-                        {
-                            substrate->setValue( (Node(x,y,0)) , -0.75 );
-                        }
-                        else if ( (b[boardx][boardy]&MAN) )
+                        if ( (x+y)%2==1 ) //ignore empty squares.
                         {
-                            substrate->setValue( (Node(x,y,0)) , -0.5 );
+                            substrate->setInputValue( (Node(x,y,0)) , 0.0 );
+                            continue;
                         }
-                        else
-                        {
-                            throw CREATE_LOCATEDEXCEPTION_INFO("Could not determine piece type (man/king)!");
-                        }
-                    }
-                    else if ( (b[boardx][boardy]&BLACK) )
-                    {
-                        //cout << "FOUND BLACK\n";
-                        if ( (b[boardx][boardy]&KING) )
+
+                        int boardx = x;
+                        int boardy = y;
+
+                        //cout << boardx << ',' << boardy << ": " << b[boardx][boardy] << endl;
+
+                        if ( (b[boardx][boardy]&WHITE) )
                         {
-                            substrate->setValue( (Node(x,y,0)) , 0.75 );
+                            //cout << "FOUND WHITE\n";
+                            if ( (b[boardx][boardy]&KING) )
+                            {
+                                substrate->setInputValue( (Node(x,y,0)) , -0.75 );
+                            }
+                            else if ( (b[boardx][boardy]&MAN) )
+                            {
+                                substrate->setInputValue( (Node(x,y,0)) , -0.5 );
+                            }
+                            else
+                            {
+                                throw CREATE_LOCATEDEXCEPTION_INFO("Could not determine piece type (man/king)!");
+                            }
                         }
-                        else if ( (b[boardx][boardy]&MAN) )
+                        else if ( (b[boardx][boardy]&BLACK) )
                         {
-                            substrate->setValue( (Node(x,y,0)) , 0.5 );
+                            //cout << "FOUND BLACK\n";
+                            if ( (b[boardx][boardy]&KING) )
+                            {
+                                substrate->setInputValue( (Node(x,y,0)) , 0.75 );
+                            }
+                            else if ( (b[boardx][boardy]&MAN) )
+                            {
+                                substrate->setInputValue( (Node(x,y,0)) , 0.5 );
+                            }
+                            else
+                            {
+                                throw CREATE_LOCATEDEXCEPTION_INFO("Could not determine piece type (man/king)!");
+                            }
                         }
                         else
                         {
-                            throw CREATE_LOCATEDEXCEPTION_INFO("Could not determine piece type (man/king)!");
+                            //cout << "FOUND NOTHING\n";
+                            substrate->setInputValue( (Node(x,y,0)) , 0.0 );
                         }
-                    }
-                    else
-                    {
-                        //cout << "FOUND NOTHING\n";
-                        substrate->setValue( (Node(x,y,0)) , 0.0 );
-                    }
 
+                    }
                 }
-            }
 
-            substrate->getNetwork()->update();
-            output = substrate->getValue((Node(0,0,2)));
+                substrate->getNetwork()->updateFromAccumulator();
+                output = substrate->getValue((Node(0,0,2)));
+            }
 
 #if CHECKERS_EXPERIMENT_DEBUG
             static CheckersNEATDatatype prevOutput;
@@ -1212,6 +1203,7 @@ namespace HCUBE
 #endif
 
 #if DEBUG_USE_BOARD_EVALUATION_CACHE
+            ushort hashVal = tmpboard.getShortHash();
             if (boardEvaluationCaches[currentSubstrateIndex][hashVal].size()<10000)
             {
                 boardEvaluationCaches[currentSubstrateIndex][hashVal].push_back(
@@ -1308,6 +1300,78 @@ namespace HCUBE
         return pair<CheckersNEATDatatype,int>(output,numHyperNEATEvaluations-1);
     }
 
+    bool CheckersExperiment::findCachedEvaluation(uchar b[8][8],CheckersNEATDatatype &output)
+    {
+        tmpboard.loadBoard(b);
+        ushort hashVal = tmpboard.getShortHash();
+
+        BoardCacheList::iterator bIterator =
+            boardEvaluationCaches[currentSubstrateIndex][hashVal].begin();
+        BoardCacheList::iterator bEnd =
+            boardEvaluationCaches[currentSubstrateIndex][hashVal].end();
+
+        for (;bIterator != bEnd;bIterator++)
+        {
+            if (bIterator->first == tmpboard)
+            {
+                //We have a match!
+                output = bIterator->second;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void CheckersExperiment::batchLeafEvaluations(
+        uchar b[8][8],
+        int firstMove,
+        int numMoves,
+        vector<int> &leafIndices,
+        vector<CheckersNEATDatatype> &leafOutputs
+    )
+    {
+        leafIndices.assign(numMoves,-1);
+        leafBatch.clear();
+
+        for (int a=0;a<numMoves;a++)
+        {
+            CheckersMove currentMove = totalMoveList.at(firstMove+a);
+
+            makeMove(currentMove,b);
+
+            //Wins end the search before a leaf is rated, and black's captures
+            //are searched further, so neither goes in the batch
+            if (getWinner(b)!=WHITE && isQuiet(b,BLACK))
+            {
+                CheckersNEATDatatype cachedOutput;
+#if DEBUG_USE_BOARD_EVALUATION_CACHE
+                if (!findCachedEvaluation(b,cachedOutput))
+#endif
+                {
+                    leafIndices[a] = leafBatch.addBoard(b);
+                }
+            }
+
+            reverseMove(currentMove,b);
+        }
+
+        if (leafBatch.getNumBoards()<2)
+        {
+            //A lone leaf is cheaper through the accumulator
+            leafIndices.assign(numMoves,-1);
+            return;
+        }
+
+        leafBatch.evaluate(substrates[currentSubstrateIndex].getNetwork());
+
+        leafOutputs.resize(leafBatch.getNumBoards());
+        for (int a=0;a<leafBatch.getNumBoards();a++)
+        {
+            leafOutputs[a] = leafBatch.getOutput(a);
+        }
+    }
+
     class CheckersBoardMoveState
     {
     public:
@@ -1332,6 +1396,13 @@ namespace HCUBE
         if (depth==0)
         {
             totalMoveList.clear();
+
+            if (DEBUG_USE_HYPERNEAT_EVALUATION)
+            {
+                //Start each search from freshly summed inputs, so the
+                //incremental updates don't carry rounding between searches
+                substrates[currentSubstrateIndex].getNetwork()->refreshAccumulator();
+            }
 #if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
             cout << "Creating new outfile\n";
             if (outfile) delete outfile;
@@ -1746,6 +1817,13 @@ namespace HCUBE
         if (depth==0)
         {
             totalMoveList.clear();
+
+            if (DEBUG_USE_HYPERNEAT_EVALUATION)
+            {
+                //Start each search from freshly summed inputs, so the
+                //incremental updates don't carry rounding between searches
+                substrates[currentSubstrateIndex].getNetwork()->refreshAccumulator();
+            }
 #if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
             cout << "Creating new outfile\n";
             if (outfile) delete outfile;
@@ -1999,6 +2077,21 @@ namespace HCUBE
             childAlphaForSecondBestMove = (CheckersNEATDatatype)(INT_MAX/2.0);
         }
 
+        //Black's replies are the leaves, so rate the quiet ones together.
+        //The debug images show each leaf's layer values, which a batch
+        //doesn't leave behind.
+        vector<int> leafIndices;
+        vector<CheckersNEATDatatype> leafOutputs;
+        if (
+            depth+1>=maxDepth &&
+            DEBUG_USE_HYPERNEAT_EVALUATION &&
+            !dumpEvaluationImages &&
+            isBatchingLeaves()
+            )
+        {
+            batchLeafEvaluations(b,oldMoveListSize,moveListCount,leafIndices,leafOutputs);
+        }
+
 		if(dumpEvaluationImages)
 		{
 			for(int a=0;a<depth;a++)
@@ -2040,7 +2133,12 @@ namespace HCUBE
 				return pair<CheckersNEATDatatype,int>(CheckersNEATDatatype(INT_MIN/2),-1);
             }
 
+            if (leafIndices.size() && leafIndices[a]>=0)
+            {
+                batchedLeafOutput = &leafOutputs[leafIndices[a]];
+            }
             childAlpha = evaluatemax(b,beta.first,depth+1,maxDepth);
+            batchedLeafOutput = NULL;
             reverseMove(currentMove,b);
 
 #if DEBUG_DO_ITERATIVE_DEEPENING
@@ -335,6 +335,24 @@ namespace HCUBE
 
         NEAT::FastNetwork<CheckersNEATDatatype> network = individual->spawnFastPhenotypeStack<CheckersNEATDatatype>();
 
+        int x1Index = network.getNodeIndex("X1");
+        int y1Index = network.getNodeIndex("Y1");
+        int x2Index = network.getNodeIndex("X2");
+        int y2Index = network.getNodeIndex("Y2");
+        int deltaXIndex = network.getNodeIndex("DeltaX");
+        int deltaYIndex = network.getNodeIndex("DeltaY");
+        int biasIndex = network.getNodeIndex("Bias");
+        int outputABIndex = network.getNodeIndex("Output_ab");
+        int outputBCIndex = network.getNodeIndex("Output_bc");
+#if DEBUG_DIRECT_LINKS
+        int outputACIndex = network.getNodeIndex("Output_ac");
+#endif
+
+        if (biasIndex==-1 || outputABIndex==-1 || outputBCIndex==-1)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("ERROR: The CPPN is missing a required node!");
+        }
+
         int linkCounter=0;
 
 #if CHECKERS_EXPERIMENT_DEBUG
@@ -450,48 +468,48 @@ namespace HCUBE
 
                                 network.reinitialize();
 
-                                if (network.hasNode("X1"))
+                                if (x1Index!=-1)
                                 {
-                                    network.setValue("X1",x1normal);
-                                    network.setValue("Y1",y1normal);
+                                    network.setIndexedValue(x1Index,x1normal);
+                                    network.setIndexedValue(y1Index,y1normal);
                                 }
-                                if (network.hasNode("X2"))
+                                if (x2Index!=-1)
                                 {
-                                    network.setValue("X2",x2normal);
-                                    network.setValue("Y2",y2normal);
+                                    network.setIndexedValue(x2Index,x2normal);
+                                    network.setIndexedValue(y2Index,y2normal);
                                 }
 
                                 //In the small board, a delta of '1' corresponds
                                 //to a delta of '2/7' on the big board because
                                 //the big board is 7/2 times bigger
 
-                                if (network.hasNode("DeltaX"))
+                                if (deltaXIndex!=-1)
                                 {
                                     //cout << x1 << ',' << x2 << ',' << y1 << ',' << y2 << endl;
                                     //cout << x1normal << ',' << x2normal << ',' << y1normal << ',' << y2normal << endl;
                                     //cout << "DeltaX:" << (x2normal-x1normal)
                                         //<< ", DeltaY: " << (y2normal-y1normal)
                                         //<< endl;
-                                    network.setValue("DeltaX",(x2normal-x1normal));
-                                    network.setValue("DeltaY",(y2normal-y1normal));
+                                    network.setIndexedValue(deltaXIndex,(x2normal-x1normal));
+                                    network.setIndexedValue(deltaYIndex,(y2normal-y1normal));
                                 }
-                                network.setValue("Bias",(CheckersNEATDatatype)0.3);
+                                network.setIndexedValue(biasIndex,(CheckersNEATDatatype)0.3);
                                 network.update();
 
                                 CheckersNEATDatatype output;
 
                                 if (z1==0 && z2==1)
                                 {
-                                    output = network.getValue("Output_ab");
+                                    output = network.getIndexedValue(outputABIndex);
                                 }
                                 else if (z1==1 && z2==2)
                                 {
-                                    output = network.getValue("Output_bc");
+                                    output = network.getIndexedValue(outputBCIndex);
                                 }
                                 else if (z1==0 && z2==2)
                                 {
 #if DEBUG_DIRECT_LINKS
-                                    output = network.getValue("Output_ac");
+                                    output = network.getIndexedValue(outputACIndex);
 #else
                                     output = 0;
 #endif
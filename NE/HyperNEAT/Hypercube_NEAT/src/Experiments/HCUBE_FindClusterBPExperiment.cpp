@@ -215,6 +215,20 @@ namespace HCUBE
     {
         //cout << "Populating substrate...";
         CPPNNetwork = individual->spawnFastPhenotypeStack<double>();
+
+        int x1Index = CPPNNetwork.getNodeIndex("X1");
+        int y1Index = CPPNNetwork.getNodeIndex("Y1");
+        int x2Index = CPPNNetwork.getNodeIndex("X2");
+        int y2Index = CPPNNetwork.getNodeIndex("Y2");
+        int deltaXIndex = CPPNNetwork.getNodeIndex("DeltaX");
+        int deltaYIndex = CPPNNetwork.getNodeIndex("DeltaY");
+        int biasIndex = CPPNNetwork.getNodeIndex("Bias");
+        int outputIndex = CPPNNetwork.getNodeIndex("Output");
+
+        if (x1Index==-1 || y1Index==-1 || x2Index==-1 || y2Index==-1 || biasIndex==-1 || outputIndex==-1)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("ERROR: The CPPN is missing a required node!");
+        }
         //progress_timer t;
 
         int linkCount=0;
@@ -237,22 +251,22 @@ namespace HCUBE
                         y2Val = (y2-numNodesY/2)/double((numNodesY-1)/2);
 
                         CPPNNetwork.reinitialize();
-                        CPPNNetwork.setValue("X1",x1Val);
-                        CPPNNetwork.setValue("Y1",y1Val);
-                        CPPNNetwork.setValue("X2",x2Val);
-                        CPPNNetwork.setValue("Y2",y2Val);
+                        CPPNNetwork.setIndexedValue(x1Index,x1Val);
+                        CPPNNetwork.setIndexedValue(y1Index,y1Val);
+                        CPPNNetwork.setIndexedValue(x2Index,x2Val);
+                        CPPNNetwork.setIndexedValue(y2Index,y2Val);
 
-                        if (CPPNNetwork.hasNode("DeltaX"))
+                        if (deltaXIndex!=-1)
                         {
-                            CPPNNetwork.setValue("DeltaX",x2Val-x1Val);
-                            CPPNNetwork.setValue("DeltaY",y2Val-y1Val);
+                            CPPNNetwork.setIndexedValue(deltaXIndex,x2Val-x1Val);
+                            CPPNNetwork.setIndexedValue(deltaYIndex,y2Val-y1Val);
                         }
 
-                        CPPNNetwork.setValue("Bias",0.3);
+                        CPPNNetwork.setIndexedValue(biasIndex,0.3);
                         CPPNNetwork.update();
 
 
-                        double greyVal = CPPNNetwork.getValue("Output");
+                        double greyVal = CPPNNetwork.getIndexedValue(outputIndex);
 
                         //substrate.getLink(counter)->weight = ( greyVal*3.0 );
 
@@ -791,6 +805,20 @@ namespace HCUBE
 
         CPPNNetwork = individual->spawnFastPhenotypeStack<double>();
 
+        int x1Index = CPPNNetwork.getNodeIndex("X1");
+        int y1Index = CPPNNetwork.getNodeIndex("Y1");
+        int x2Index = CPPNNetwork.getNodeIndex("X2");
+        int y2Index = CPPNNetwork.getNodeIndex("Y2");
+        int deltaXIndex = CPPNNetwork.getNodeIndex("DeltaX");
+        int deltaYIndex = CPPNNetwork.getNodeIndex("DeltaY");
+        int biasIndex = CPPNNetwork.getNodeIndex("Bias");
+        int outputIndex = CPPNNetwork.getNodeIndex("Output");
+
+        if (x1Index==-1 || y1Index==-1 || x2Index==-1 || y2Index==-1 || biasIndex==-1 || outputIndex==-1)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("ERROR: The CPPN is missing a required node!");
+        }
+
         populateSubstrate(individual);
         for(int epoch=0;;epoch++)
         {
@@ -888,23 +916,23 @@ namespace HCUBE
                         y2Val = (y2-numNodesY/2)/double((numNodesY-1)/2);
 
                         CPPNNetwork.reinitialize();
-                        CPPNNetwork.setValue("X1",x1Val);
-                        CPPNNetwork.setValue("Y1",y1Val);
-                        CPPNNetwork.setValue("X2",x2Val);
-                        CPPNNetwork.setValue("Y2",y2Val);
+                        CPPNNetwork.setIndexedValue(x1Index,x1Val);
+                        CPPNNetwork.setIndexedValue(y1Index,y1Val);
+                        CPPNNetwork.setIndexedValue(x2Index,x2Val);
+                        CPPNNetwork.setIndexedValue(y2Index,y2Val);
 
-                        if (CPPNNetwork.hasNode("DeltaX"))
+                        if (deltaXIndex!=-1)
                         {
-                            CPPNNetwork.setValue("DeltaX",x2Val-x1Val);
-                            CPPNNetwork.setValue("DeltaY",y2Val-y1Val);
+                            CPPNNetwork.setIndexedValue(deltaXIndex,x2Val-x1Val);
+                            CPPNNetwork.setIndexedValue(deltaYIndex,y2Val-y1Val);
                         }
 
-                        CPPNNetwork.setValue("Bias",0.3);
+                        CPPNNetwork.setIndexedValue(biasIndex,0.3);
                         CPPNNetwork.dummyActivation();
                         CPPNNetwork.update(2);
 
 
-                        double greyVal = CPPNNetwork.getValue("Output");
+                        double greyVal = CPPNNetwork.getIndexedValue(outputIndex);
 
                         //substrate.getLink(counter)->weight = ( greyVal*3.0 );
 
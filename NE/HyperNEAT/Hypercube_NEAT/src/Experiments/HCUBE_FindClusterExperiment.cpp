@@ -203,6 +203,20 @@ namespace HCUBE
         cout << "Populating substrate...";
 #endif
         NEAT::FastNetwork<double> network = individual->spawnFastPhenotypeStack<double>();
+
+        int x1Index = network.getNodeIndex("X1");
+        int y1Index = network.getNodeIndex("Y1");
+        int x2Index = network.getNodeIndex("X2");
+        int y2Index = network.getNodeIndex("Y2");
+        int deltaXIndex = network.getNodeIndex("DeltaX");
+        int deltaYIndex = network.getNodeIndex("DeltaY");
+        int biasIndex = network.getNodeIndex("Bias");
+        int outputIndex = network.getNodeIndex("Output");
+
+        if (x1Index==-1 || y1Index==-1 || x2Index==-1 || y2Index==-1 || biasIndex==-1 || outputIndex==-1)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("ERROR: The CPPN is missing a required node!");
+        }
         //progress_timer t;
 
         int linkCount=0;
@@ -225,22 +239,22 @@ namespace HCUBE
                         y2Val = (y2-numNodesY/2)/double((numNodesY-1)/2);
 
                         network.reinitialize();
-                        network.setValue("X1",x1Val);
-                        network.setValue("Y1",y1Val);
-                        network.setValue("X2",x2Val);
-                        network.setValue("Y2",y2Val);
+                        network.setIndexedValue(x1Index,x1Val);
+                        network.setIndexedValue(y1Index,y1Val);
+                        network.setIndexedValue(x2Index,x2Val);
+                        network.setIndexedValue(y2Index,y2Val);
 
-                        if (network.hasNode("DeltaX"))
+                        if (deltaXIndex!=-1)
                         {
-                            network.setValue("DeltaX",x2Val-x1Val);
-                            network.setValue("DeltaY",y2Val-y1Val);
+                            network.setIndexedValue(deltaXIndex,x2Val-x1Val);
+                            network.setIndexedValue(deltaYIndex,y2Val-y1Val);
                         }
 
-                        network.setValue("Bias",0.3);
+                        network.setIndexedValue(biasIndex,0.3);
                         network.update();
 
 
-                        double greyVal = network.getValue("Output");
+                        double greyVal = network.getIndexedValue(outputIndex);
 
                         //substrate.getLink(counter)->weight = ( greyVal*3.0 );
 
@@ -319,18 +319,16 @@ namespace HCUBE
         int boundsLayer = substrates[0].getLayerIndex("OutOfBounds");
         if(boundsLayer>=0)
         {
-            for(int r=0;r<goBoardSize+4;r++)
+            LayerView<GoNEATDatatype> bounds = substrates[0].getInputLayer(boundsLayer);
+            for(int c=0;c<goBoardSize+4;c++)
             {
-                for(int c=0;c<goBoardSize+4;c++)
+                GoNEATDatatype *boundsRow = bounds.row(c);
+                bool rowInBounds = (c>=2 && c<=goBoardSize+1);
+
+                std::fill(boundsRow,boundsRow+goBoardSize+4,GoNEATDatatype(-1));
+                if(rowInBounds)
                 {
-                    if(r<2||c<2||r>goBoardSize+1||c>goBoardSize+1)
-                    {
-                        substrates[0].setValue( Node(r,c,boundsLayer) , -1 );
-                    }
-                    else
-                    {
-                        substrates[0].setValue( Node(r,c,boundsLayer) , 1 );
-                    }
+                    std::fill(boundsRow+2,boundsRow+goBoardSize+2,GoNEATDatatype(1));
                 }
             }
         }
@@ -658,6 +656,10 @@ namespace HCUBE
 
         //First, have HyperNEAT generate a move
 		substrates[0].getNetwork()->reinitialize();
+        LayerView<GoNEATDatatype> pieces = substrates[0].getInputLayer(0);
+#if !USE_SINGLE_LAYER_FOR_PIECES
+        LayerView<GoNEATDatatype> whitePieces = substrates[0].getInputLayer(1);
+#endif
         for(int r=0;r<goBoardSize;r++)
         {
             for(int c=0;c<goBoardSize;c++)
@@ -666,34 +668,19 @@ namespace HCUBE
 #if USE_SINGLE_LAYER_FOR_PIECES
                 if(boardColor==SG_BLACK)
                 {
-                    substrates[0].setValue( Node(r,c,0) , 1 );
+                    pieces(r,c) = 1;
                 }
                 else if(boardColor==SG_WHITE)
                 {
-                    substrates[0].setValue( Node(r,c,0) , -1 );
+                    pieces(r,c) = -1;
                 }
                 else //c==SG_EMPTY
                 {
-                    substrates[0].setValue( Node(r,c,0) , 0 );
+                    pieces(r,c) = 0;
                 }
 #else
-                if(boardColor==SG_BLACK)
-                {
-                    substrates[0].setValue( Node(r,c,0) , 1 );
-                }
-                else
-                {
-                    substrates[0].setValue( Node(r,c,0) , -1 );
-                }
-
-                if(boardColor==SG_WHITE)
-                {
-                    substrates[0].setValue( Node(r,c,1) , 1 );
-                }
-                else
-                {
-                    substrates[0].setValue( Node(r,c,1) , -1 );
-                }
+                pieces(r,c) = (boardColor==SG_BLACK) ? 1 : -1;
+                whitePieces(r,c) = (boardColor==SG_WHITE) ? 1 : -1;
 #endif
             }
         }
@@ -702,6 +689,7 @@ namespace HCUBE
 
         //Get a sorted list of moves to make
         moves.clear();
+        LayerView<const GoNEATDatatype> output = substrates[0].getOutputLayer(substrates[0].getLayerIndex("Output"));
         for(int r=0;r<goBoardSize;r++)
         {
             for(int c=0;c<goBoardSize;c++)
@@ -711,8 +699,7 @@ namespace HCUBE
                     self->Board().IsLegal(p)
                     )
                 {
-                    int index = substrates[0].getLayerIndex("Output");
-                    float moveMotivation = substrates[0].getValue(Node(r,c,index));
+                    float moveMotivation = output(r,c);
 
                     if(moveMotivation>0)
                     {
@@ -749,6 +736,10 @@ namespace HCUBE
         bool boardChanged=false;
         bool boardEmpty=true;
         //First, have HyperNEAT generate a move
+        LayerView<GoNEATDatatype> pieces = substrates[0].getInputLayer(0);
+#if !USE_SINGLE_LAYER_FOR_PIECES
+        LayerView<GoNEATDatatype> whitePieces = substrates[0].getInputLayer(1);
+#endif
         for(int r=0;r<goBoardSize;r++)
         {
             for(int c=0;c<goBoardSize;c++)
@@ -757,48 +748,33 @@ namespace HCUBE
 #if USE_SINGLE_LAYER_FOR_PIECES
                 if(boardColor==SG_BLACK)
                 {
-                    if( substrates[0].getValue( Node(r,c,0) ) != 1.0f)
+                    if( pieces(r,c) != 1.0f)
                     {
                         boardChanged = true;
                     }
                     boardEmpty = false;
-                    substrates[0].setValue( Node(r,c,0) , 1.0f );
+                    pieces(r,c) = 1.0f;
                 }
                 else if(boardColor==SG_WHITE)
                 {
-                    if( substrates[0].getValue( Node(r,c,0) ) != -1.0f)
+                    if( pieces(r,c) != -1.0f)
                     {
                         boardChanged = true;
                     }
                     boardEmpty = false;
-                    substrates[0].setValue( Node(r,c,0) , -1.0f );
+                    pieces(r,c) = -1.0f;
                 }
                 else //c==SG_EMPTY
                 {
-                    if( substrates[0].getValue( Node(r,c,0) ) != 0.0f)
+                    if( pieces(r,c) != 0.0f)
                     {
                         boardChanged = true;
                     }
-                    substrates[0].setValue( Node(r,c,0) , 0.0f );
+                    pieces(r,c) = 0.0f;
                 }
 #else
-                if(boardColor==SG_BLACK)
-                {
-                    substrates[0].setValue( Node(r,c,0) , 1 );
-                }
-                else
-                {
-                    substrates[0].setValue( Node(r,c,0) , -1 );
-                }
-
-                if(boardColor==SG_WHITE)
-                {
-                    substrates[0].setValue( Node(r,c,1) , 1 );
-                }
-                else
-                {
-                    substrates[0].setValue( Node(r,c,1) , -1 );
-                }
+                pieces(r,c) = (boardColor==SG_BLACK) ? 1 : -1;
+                whitePieces(r,c) = (boardColor==SG_WHITE) ? 1 : -1;
 #endif
             }
         }
@@ -816,7 +792,7 @@ namespace HCUBE
         }
 
         int index = substrates[0].getLayerIndex("Output");
-        float rawValue = substrates[0].getValue(Node( SgPointUtil::Row(p)-1 , SgPointUtil::Col(p)-1 ,index));
+        float rawValue = substrates[0].getOutputLayer(index)( SgPointUtil::Row(p)-1 , SgPointUtil::Col(p)-1 );
 
         //negative values don't make sense, so scale to be [0-1]
         return (rawValue+1.0) / 2.0;
@@ -158,6 +158,18 @@ namespace HCUBE
 
 		NEAT::FastNetwork<float> network = individual->spawnFastPhenotypeStack<float>();
 
+		int xIndex = network.getNodeIndex("X");
+		int yIndex = network.getNodeIndex("Y");
+		int biasIndex = network.getNodeIndex("Bias");
+		int output1RIndex = network.getNodeIndex("Output_1R");
+		int output1GIndex = network.getNodeIndex("Output_1G");
+		int output1BIndex = network.getNodeIndex("Output_1B");
+
+		if (xIndex==-1 || yIndex==-1 || output1RIndex==-1 || output1GIndex==-1 || output1BIndex==-1)
+		{
+			throw CREATE_LOCATEDEXCEPTION_INFO("ERROR: The CPPN is missing a required node!");
+		}
+
 		double totalFitness = 0;
 
 		Pixel biggestSpread;
@@ -189,26 +201,26 @@ namespace HCUBE
 				}
 
 				network.reinitialize();
-				network.setValue("X",xnormal);
-				network.setValue("Y",ynormal);
+				network.setIndexedValue(xIndex,xnormal);
+				network.setIndexedValue(yIndex,ynormal);
 
-				if(network.hasNode("Bias"))
+				if(biasIndex!=-1)
 				{
-					network.setValue("Bias",(float)0.3);
+					network.setIndexedValue(biasIndex,(float)0.3);
 				}
 
 				network.update();
 
 				{
-					float unsignedVal = (network.getValue("Output_1R")+1.0)/2.0;
+					float unsignedVal = (network.getIndexedValue(output1RIndex)+1.0)/2.0;
 					tmpimage[y][x].r = smallest.r + unsignedVal*(spread.r);
 				}
 				{
-					float unsignedVal = (network.getValue("Output_1G")+1.0)/2.0;
+					float unsignedVal = (network.getIndexedValue(output1GIndex)+1.0)/2.0;
 					tmpimage[y][x].g = smallest.g + unsignedVal*(spread.g);
 				}
 				{
-					float unsignedVal = (network.getValue("Output_1B")+1.0)/2.0;
+					float unsignedVal = (network.getIndexedValue(output1BIndex)+1.0)/2.0;
 					tmpimage[y][x].b = smallest.b + unsignedVal*(spread.b);
 				}
 				//tmpimage[y][x].a = 128 + int(network.getValue("Output_1A")*128);
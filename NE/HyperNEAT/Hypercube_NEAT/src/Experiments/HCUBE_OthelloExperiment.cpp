@@ -293,6 +293,29 @@ namespace HCUBE
 
 		NEAT::FastNetwork<OthelloNEATDatatype> network = individual->spawnFastPhenotypeStack<OthelloNEATDatatype>();
 
+		int x1Index = network.getNodeIndex("X1");
+		int y1Index = network.getNodeIndex("Y1");
+		int x2Index = network.getNodeIndex("X2");
+		int y2Index = network.getNodeIndex("Y2");
+		int deltaXIndex = network.getNodeIndex("DeltaX");
+		int deltaYIndex = network.getNodeIndex("DeltaY");
+		int biasIndex = network.getNodeIndex("Bias");
+		int outputABIndex = network.getNodeIndex("Output_ab");
+		int outputBCIndex = network.getNodeIndex("Output_bc");
+#if DEBUG_DIRECT_LINKS
+		int outputACIndex = network.getNodeIndex("Output_ac");
+#endif
+
+		if (x1Index==-1 || y1Index==-1 || biasIndex==-1 || outputABIndex==-1 || outputBCIndex==-1)
+		{
+			throw CREATE_LOCATEDEXCEPTION_INFO("ERROR: The CPPN is missing a required node!");
+		}
+
+		if (deltaXIndex==-1)
+		{
+			throw CREATE_LOCATEDEXCEPTION_INFO("THIS NETWORK HAS NO DELTAS BY ACCIDENT!\n");
+		}
+
 		int linkCounter=0;
 
 #if OTHELLO_EXPERIMENT_DEBUG
@@ -351,39 +374,32 @@ namespace HCUBE
 								}
 
 								network.reinitialize();
-								network.setValue("X1",x1normal);
-								network.setValue("Y1",y1normal);
-								if (network.hasNode("X2"))
-								{
-									network.setValue("X2",x2normal);
-									network.setValue("Y2",y2normal);
-								}
-								if (network.hasNode("DeltaX"))
-								{
-									network.setValue("DeltaX",x2normal-x1normal);
-									network.setValue("DeltaY",y2normal-y1normal);
-								}
-								else
+								network.setIndexedValue(x1Index,x1normal);
+								network.setIndexedValue(y1Index,y1normal);
+								if (x2Index!=-1)
 								{
-									throw CREATE_LOCATEDEXCEPTION_INFO("THIS NETWORK HAS NO DELTAS BY ACCIDENT!\n");
+									network.setIndexedValue(x2Index,x2normal);
+									network.setIndexedValue(y2Index,y2normal);
 								}
-								network.setValue("Bias",(OthelloNEATDatatype)0.3);
+								network.setIndexedValue(deltaXIndex,x2normal-x1normal);
+								network.setIndexedValue(deltaYIndex,y2normal-y1normal);
+								network.setIndexedValue(biasIndex,(OthelloNEATDatatype)0.3);
 								network.update();
 
 								OthelloNEATDatatype output;
 
 								if (z1==0 && z2==1)
 								{
-									output = network.getValue("Output_ab");
+									output = network.getIndexedValue(outputABIndex);
 								}
 								else if (z1==1 && z2==2)
 								{
-									output = network.getValue("Output_bc");
+									output = network.getIndexedValue(outputBCIndex);
 								}
 								else if (z1==0 && z2==2)
 								{
 #if DEBUG_DIRECT_LINKS
-									output = network.getValue("Output_ac");
+									output = network.getIndexedValue(outputACIndex);
 #else
 									output = 0;
 #endif
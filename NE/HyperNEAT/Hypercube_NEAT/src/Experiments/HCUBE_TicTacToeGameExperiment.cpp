@@ -204,6 +204,23 @@ namespace HCUBE
     {
         NEAT::FastNetwork<double> network = individual->spawnFastPhenotypeStack<double>();
 
+        int x1Index = network.getNodeIndex("X1");
+        int y1Index = network.getNodeIndex("Y1");
+        int x2Index = network.getNodeIndex("X2");
+        int y2Index = network.getNodeIndex("Y2");
+        int deltaXIndex = network.getNodeIndex("DeltaX");
+        int deltaYIndex = network.getNodeIndex("DeltaY");
+        int biasIndex = network.getNodeIndex("Bias");
+        int outputABIndex = network.getNodeIndex("Output_ab");
+        int outputBCIndex = network.getNodeIndex("Output_bc");
+        int biasBIndex = network.getNodeIndex("Bias_b");
+        int biasCIndex = network.getNodeIndex("Bias_c");
+
+        if (x1Index==-1 || y1Index==-1 || biasIndex==-1 || outputABIndex==-1 || outputBCIndex==-1 || biasBIndex==-1 || biasCIndex==-1)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("ERROR: The CPPN is missing a required node!");
+        }
+
         int linkCounter=0;
         for (int y1=0;y1<numNodesY;y1++)
         {
@@ -220,23 +237,23 @@ namespace HCUBE
                         double y2normal = (y2-numNodesY/2)/double((numNodesY-1)/2);
 
                         network.reinitialize();
-                        network.setValue("X1",x1normal);
-                        network.setValue("Y1",y1normal);
-                        if (network.hasNode("X2"))
+                        network.setIndexedValue(x1Index,x1normal);
+                        network.setIndexedValue(y1Index,y1normal);
+                        if (x2Index!=-1)
                         {
-                            network.setValue("X2",x2normal);
-                            network.setValue("Y2",y2normal);
+                            network.setIndexedValue(x2Index,x2normal);
+                            network.setIndexedValue(y2Index,y2normal);
                         }
-                        if (network.hasNode("DeltaX"))
+                        if (deltaXIndex!=-1)
                         {
-                            network.setValue("DeltaX",x2normal-x1normal);
-                            network.setValue("DeltaY",y2normal-y1normal);
+                            network.setIndexedValue(deltaXIndex,x2normal-x1normal);
+                            network.setIndexedValue(deltaYIndex,y2normal-y1normal);
                         }
-                        network.setValue("Bias",0.3);
+                        network.setIndexedValue(biasIndex,0.3);
                         network.update();
 
-                        double outputAB = network.getValue("Output_ab");
-                        double outputBC = network.getValue("Output_bc");
+                        double outputAB = network.getIndexedValue(outputABIndex);
+                        double outputBC = network.getIndexedValue(outputBCIndex);
 
                         if (fabs(outputAB)>0.2)
                         {
@@ -270,14 +287,14 @@ namespace HCUBE
                         {
                             double nodeBias;
 
-                            nodeBias = network.getValue("Bias_b");
+                            nodeBias = network.getIndexedValue(biasBIndex);
 
                             //substrate.setBias(
                                 //nameLookup[Node(x1-numNodesX/2,y1-numNodesY/2,1)],
                                 //nodeBias
                             //);
 
-                            nodeBias = network.getValue("Bias_c");
+                            nodeBias = network.getIndexedValue(biasCIndex);
 
                             //substrate.setBias(
                                 //nameLookup[Node(x1-numNodesX/2,y1-numNodesY/2,2)],
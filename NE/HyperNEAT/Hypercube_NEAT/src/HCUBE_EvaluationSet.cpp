@@ -20,6 +20,17 @@ namespace HCUBE
             vector<shared_ptr<NEAT::GeneticIndividual> >::iterator tmpIterator;
 
             tmpIterator = individualIterator;
+
+            //Each group draws from its own stream, numbered by the index of
+            //its first individual, so an evaluation gets the same random
+            //numbers however the population is split among threads
+            NEAT::Random evaluationRandoms =
+                NEAT::Globals::getSingleton()->getRandom().getStream(
+                    NEAT::RANDOM_STREAM_EVALUATION,
+                    generation->getGenerationNumber()
+                );
+            int groupStart=0;
+
             for (int a=0;a<individualCount;a++,tmpIterator++)
             {
                 while (!running)
@@ -30,10 +41,17 @@ namespace HCUBE
                     boost::thread::sleep(xt); // Sleep for 1 second
                 }
 
+                if (experiment->getGroupSize()==0)
+                {
+                    groupStart = int(tmpIterator-generation->getIndividualIterator(0));
+                }
+
                 experiment->addIndividualToGroup(*tmpIterator);
 
                 if (experiment->getGroupSize()==experiment->getGroupCapacity())
                 {
+                    NEAT::RandomStreamScope groupRandom(evaluationRandoms.getStream(groupStart));
+
                     //cout << "Processing group...\n";
                     experiment->processGroup(generation);
                     //cout << "Done Processing group\n";
@@ -0,0 +1,122 @@
+#include "HCUBE_Defines.h"
+
+/**
+ * Times the link accumulation of random CPPNs with 50-300 links, in gene
+ * order (the old scatter-add) against the incoming link table that
+ * FastNetwork updates walk, along with a full FastNetwork::update().
+ */
+void benchmarkNetworkLinks(int iterations)
+{
+    NEAT::Globals::init();
+    NEAT::Globals::getSingleton()->seedRandom(0);
+
+    vector<NEAT::GeneticNodeGene> genes;
+    genes.push_back(NEAT::GeneticNodeGene("Bias","NetworkSensor",0,false));
+    genes.push_back(NEAT::GeneticNodeGene("X1","NetworkSensor",0,false));
+    genes.push_back(NEAT::GeneticNodeGene("Y1","NetworkSensor",0,false));
+    genes.push_back(NEAT::GeneticNodeGene("X2","NetworkSensor",0,false));
+    genes.push_back(NEAT::GeneticNodeGene("Y2","NetworkSensor",0,false));
+    genes.push_back(NEAT::GeneticNodeGene("Output","NetworkOutputNode",1,false,ACTIVATION_FUNCTION_SIGMOID));
+
+    for (int targetLinks=50;targetLinks<=300;targetLinks+=50)
+    {
+        shared_ptr<NEAT::GeneticIndividual> individual(new NEAT::GeneticIndividual(genes,true,1.0));
+        while (individual->getLinksCount()<targetLinks)
+        {
+            //Add a hidden node whenever there's no room for another link
+            if (!individual->mutateAddLink())
+            {
+                individual->mutateAddNode();
+            }
+        }
+
+        NEAT::FastNetwork<float> network = individual->spawnFastPhenotypeStack<float>();
+
+        //Copy the links out in gene order
+        int numLinks = network.getLinkCount();
+        int numNodes = 0;
+        vector<NEAT::NetworkIndexedLink<float> > links(numLinks);
+        for (int a=0;a<numLinks;a++)
+        {
+            links[a] = *network.getLink(a);
+            numNodes = max(numNodes,max(links[a].fromNode,links[a].toNode)+1);
+        }
+        NEAT::IncomingLinkTable<float> incomingLinks;
+        incomingLinks.build(&links[0],numLinks,numNodes,0);
+
+        vector<float> values(numNodes,0.5f);
+        vector<float> newValues(numNodes);
+        double checksum=0.0;
+
+        boost::timer geneOrderTimer;
+        for (int a=0;a<iterations;a++)
+        {
+            memset(&newValues[0],0,sizeof(float)*numNodes);
+            for (int b=0;b<numLinks;b++)
+            {
+                newValues[links[b].toNode] += values[links[b].fromNode]*links[b].weight;
+            }
+            checksum += newValues[a%numNodes];
+        }
+        double geneOrderTime = geneOrderTimer.elapsed();
+
+        boost::timer incomingTimer;
+        for (int a=0;a<iterations;a++)
+        {
+            for (int b=0;b<numNodes;b++)
+            {
+                newValues[b] = incomingLinks.sum(b,&values[0],0.0f);
+            }
+            checksum += newValues[a%numNodes];
+        }
+        double incomingTime = incomingTimer.elapsed();
+
+        boost::timer updateTimer;
+        for (int a=0;a<iterations;a++)
+        {
+            network.reinitialize();
+            network.setValue("X1",0.5f);
+            network.update();
+            checksum += network.getValue("Output");
+        }
+        double updateTime = updateTimer.elapsed();
+
+        cout << numLinks << " links, " << numNodes << " nodes: "
+             << "gene order " << (geneOrderTime*1e9/(double(iterations)*numLinks)) << " ns/link, "
+             << "incoming table " << (incomingTime*1e9/(double(iterations)*numLinks)) << " ns/link, "
+             << "update() " << (updateTime*1e6/iterations) << " us"
+             << " (checksum " << checksum << ")" << endl;
+    }
+}
+
+int main(int argc,char **argv)
+{
+    int iterations = 100000;
+    if (argc>1)
+    {
+        iterations = stringTo<int>(argv[1]);
+    }
+    else
+    {
+        cout << "Syntax: ./Hypercube_NEAT_Benchmark [iterations]\n";
+    }
+
+    try
+    {
+        benchmarkNetworkLinks(iterations);
+    }
+    catch (const std::exception &ex)
+    {
+        cout << "CAUGHT ERROR AT " << __FILE__ << " : " << __LINE__ << endl;
+        cout << "An exception has occured: " << ex.what() << endl;
+        return 1;
+    }
+    catch (...)
+    {
+        cout << "CAUGHT ERROR AT " << __FILE__ << " : " << __LINE__ << endl;
+        cout << "An error has occured!\n";
+        return 1;
+    }
+
+    return 0;
+}
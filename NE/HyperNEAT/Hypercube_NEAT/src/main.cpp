@@ -403,6 +403,10 @@ catch (...)
 }
 #endif
 
+NEAT::SubstrateCache<float>::deinit();
+NEAT::SubstrateCache<double>::deinit();
+NEAT::NetworkCompiler<float>::deinit();
+NEAT::NetworkCompiler<double>::deinit();
 NEAT::Globals::deinit();
 
 #endif
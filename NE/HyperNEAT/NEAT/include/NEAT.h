@@ -6,8 +6,10 @@
 #include "NEAT_Network.h"
 #include "NEAT_ModularNetwork.h"
 #include "NEAT_FastNetwork.h"
+#include "NEAT_NetworkCompiler.h"
 #include "NEAT_FastBiasNetwork.h"
 #include "NEAT_LayeredSubstrate.h"
+#include "NEAT_SubstrateCache.h"
 #include "NEAT_NetworkLink.h"
 #include "NEAT_NetworkNode.h"
 #include "NEAT_GeneticIndividual.h"
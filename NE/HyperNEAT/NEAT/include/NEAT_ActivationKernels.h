@@ -0,0 +1,60 @@
+#ifndef NEAT_ACTIVATIONKERNELS_H_INCLUDED
+#define NEAT_ACTIVATIONKERNELS_H_INCLUDED
+
+#include "NEAT_Globals.h"
+
+namespace NEAT
+{
+    /**
+     *  A run of nodes [begin,end) in a node list that all share the
+     *  same activation function
+     */
+    class ActivationGroup
+    {
+    public:
+        ActivationFunction function;
+        int begin,end;
+
+        ActivationGroup()
+                :
+                function(ACTIVATION_FUNCTION_SIGMOID),
+                begin(0),
+                end(0)
+        {}
+
+        ActivationGroup(ActivationFunction _function,int _begin,int _end)
+                :
+                function(_function),
+                begin(_begin),
+                end(_end)
+        {}
+    };
+
+    /**
+     * runActivationKernel: Applies one activation function to many values.
+     * If indices is NULL, output[a] = f(input[a]) for a in [0,count).
+     * Otherwise output[indices[a]] = f(input[indices[a]]) for a in [0,count).
+     * input and output may be the same array.
+     *
+     * ACTIVATION_ACCURACY_EXACT gives the same values as the per-node
+     * FastNetwork::runActivationFunction.  ACTIVATION_ACCURACY_FAST replaces
+     * exp/sin/cos with polynomials.  The table sigmoids stay within 5e-4 of
+     * the tables, which is the tables' own quantization error.  Everything
+     * else stays within about 1e-6 (relative for the unbounded unsigned tanh
+     * sigmoid), with sin/cos checked for |x| up to 1e4.  Square, abs-root,
+     * linear and ones compliment are exact at either level.
+     */
+    template<class Type>
+    NEAT_DLL_EXPORT void runActivationKernel(
+        ActivationFunction function,
+        const int *indices,
+        int count,
+        const Type *input,
+        Type *output,
+        bool signedActivation,
+        bool usingTanhSigmoid,
+        ActivationAccuracy accuracy
+    );
+}
+
+#endif // NEAT_ACTIVATIONKERNELS_H_INCLUDED
@@ -6,6 +6,7 @@
 #include "NEAT_NetworkNode.h"
 #include "NEAT_NetworkLink.h"
 #include "NEAT_NetworkIndexedLink.h"
+#include "NEAT_IncomingLinkTable.h"
 
 namespace NEAT
 {
@@ -35,6 +36,15 @@ namespace NEAT
          */
         int numConstantNodes;
 
+        /**
+         * incomingLinks holds the links into the updated nodes grouped by
+         * destination, which is what the update walks.  links stays in gene
+         * order for getLink().  linkWeightsChanged is set whenever a link is
+         * handed out, and the next update copies the weights over.
+         */
+        IncomingLinkTable<Type> incomingLinks;
+        bool linkWeightsChanged;
+
     public:
         /**
          *  (Constructor) Create a Network with the inputed toplogy
@@ -109,16 +119,19 @@ namespace NEAT
         NEAT_DLL_EXPORT Type getBias(const string &nodeName);
 
         /**
-         *  getLink: gets the link according to its index when created
+         *  getLink: gets the link according to its index when created.
+         *  Changes to the weight are picked up by the next update, so
+         *  don't hold on to the pointer across updates.
          */
         NetworkIndexedLink<Type> *getLink(int index)
         {
+            linkWeightsChanged=true;
             return &links[index];
         }
 
         /**
          *  getLink: gets the link according to the names
-         *  of it's nodes
+         *  of it's nodes.  The same rules as getLink(index) apply.
          */
         NEAT_DLL_EXPORT NetworkIndexedLink<Type> *getLink(const string &fromNodeName,const string &toNodeName);
 
@@ -7,14 +7,70 @@
 #include "NEAT_NetworkLink.h"
 #include "NEAT_NetworkIndexedLink.h"
 
+#include "NEAT_LayerKernels.h"
+
 namespace NEAT
 {
+    /**
+     *  A view of a 2-D sheet of node values that writes straight into the
+     *  network.  Node (x,y) is at data[y*stride+x], so each row of width
+     *  values is contiguous and can be filled with memcpy.  The view is
+     *  only good until the network is rebuilt.
+     */
+    template<class Type>
+    class LayerView
+    {
+    public:
+        Type *data;
+        int width,height;
+        int stride;
+
+        LayerView()
+                :
+                data(NULL),
+                width(0),
+                height(0),
+                stride(0)
+        {}
+
+        LayerView(Type *_data,int _width,int _height,int _stride)
+                :
+                data(_data),
+                width(_width),
+                height(_height),
+                stride(_stride)
+        {}
+
+        inline Type &operator()(int x,int y) const
+        {
+            return data[size_t(y)*stride+x];
+        }
+
+        inline Type *row(int y) const
+        {
+            return data+size_t(y)*stride;
+        }
+
+        inline void fill(Type value) const
+        {
+            for (int y=0;y<height;y++)
+            {
+                std::fill(row(y),row(y)+width,value);
+            }
+        }
+    };
+
     template<class Type>
     class NetworkLayer
     {
     public:
         string name;
         vector<int> fromLayers;
+
+        /**
+         * fromWeights[a] holds the weights from fromLayers[a], one row of
+         * that layer's size per node of this layer
+         */
         vector< vector< Type > > fromWeights;
         vector<Type> nodeValues;
 
@@ -42,7 +98,7 @@ namespace NEAT
             {
                 fromWeights.push_back(
                     vector< Type >(
-                        nodeValues.size()*layerSizes[a].x*layerSizes[a].y,0.0f
+                        nodeValues.size()*layerSizes[fromLayers[a]].x*layerSizes[fromLayers[a]].y,0.0f
                         )
                     );
             }
@@ -54,10 +110,73 @@ namespace NEAT
         }
     };
 
+    /**
+     *  The weights of a FastLayeredNetwork.  Once built they are not
+     *  changed while shared, so any number of networks made from one
+     *  network can read them at once, each with its own node values.
+     */
+    template<class Type>
+    class FastLayeredNetworkWeights
+    {
+    public:
+        /**
+         * layerWeights[layer][a] holds the weights from the layer's
+         * fromLayers[a], padded for the layer kernels
+         */
+        vector< vector< PaddedMatrix<Type> > > layerWeights;
+
+        /**
+         * When weightsAreSparse[layer][a] is set, the weights from the
+         * layer's fromLayers[a] are in sparseWeights[layer][a] instead and
+         * layerWeights[layer][a] is empty.  A layer pair is made sparse on
+         * construction if its density is under
+         * Globals::getSparseLayerDensity().
+         */
+        vector< vector< SparseMatrix<Type> > > sparseWeights;
+        vector< vector<bool> > weightsAreSparse;
+
+    protected:
+        /**
+         * transposedWeights[layer][a] is the transpose of the weights from
+         * fromLayers[a] for each layer whose source layers are all input
+         * layers, so the weights out of one input node are contiguous.
+         * Other layers have none.  They are built on first use.
+         */
+        mutable vector< vector< PaddedMatrix<Type> > > transposedWeights;
+        mutable bool transposedWeightsBuilt;
+        mutable boost::mutex transposedWeightsMutex;
+
+    public:
+        NEAT_DLL_EXPORT FastLayeredNetworkWeights();
+
+        NEAT_DLL_EXPORT FastLayeredNetworkWeights(const FastLayeredNetworkWeights<Type> &other);
+
+        /**
+         * getTransposedWeights: Returns the transposed weights of the
+         * network with the given layers, building them if needed.  It is
+         * safe to call from several threads.
+         */
+        NEAT_DLL_EXPORT const vector< vector< PaddedMatrix<Type> > > &getTransposedWeights(
+            const vector<NetworkLayer<Type> > &layers
+        ) const;
+
+        /**
+         * clearTransposedWeights: Drops the transposed weights after the
+         * weights have changed
+         */
+        NEAT_DLL_EXPORT void clearTransposedWeights();
+    };
+
     /**
      *  The FastLayeredNetwork class is designed to be faster at the cost
      *  of being less dynamic.  Adding/Removing links and nodes
      *  is not supported with this network.
+     *
+     *  The weights are kept in a FastLayeredNetworkWeights that copies of
+     *  the network share.  A copy only owns its node values, so it is a
+     *  cheap activation context: several threads can each update their own
+     *  copy of one network at the same time.  setLink() gives the network
+     *  its own weights first if they are shared.
      */
     template<class Type>
     class FastLayeredNetwork : public Network<Type>
@@ -65,6 +184,34 @@ namespace NEAT
     protected:
         vector<NetworkLayer<Type> > layers;
 
+        /**
+         * The layers' fromWeights are moved in here on construction
+         */
+        shared_ptr<const FastLayeredNetworkWeights<Type> > weights;
+
+        /**
+         * paddedValues holds each layer's node values padded with zeros,
+         * which is what the layer kernels read and write
+         */
+        vector< typename PaddedMatrix<Type>::AlignedVector > paddedValues;
+
+        /**
+         * batchValues holds each layer's padded node values for every
+         * sample of updateBatch(), one after another
+         */
+        vector< typename PaddedMatrix<Type>::AlignedVector > batchValues;
+
+        /**
+         * accumulatorValues holds the sums, before the activation, of each
+         * layer whose source layers are all input layers.  setInputValue()
+         * keeps them up to date, so a search only pays for the inputs a
+         * move changes.  accumulatorWeights points at the shared weights'
+         * transposed weights once the accumulator has been refreshed.
+         */
+        vector< typename PaddedMatrix<Type>::AlignedVector > accumulatorValues;
+        const vector< vector< PaddedMatrix<Type> > > *accumulatorWeights;
+        bool accumulatorValid;
+
     public:
         /**
          *  (Constructor) Create a Network with the inputed toplogy
@@ -80,6 +227,15 @@ namespace NEAT
 
         NEAT_DLL_EXPORT virtual ~FastLayeredNetwork();
 
+        /**
+         * getWeights: Returns the weights, which are shared with every copy
+         * of this network that has not called setLink() since
+         */
+        inline shared_ptr<const FastLayeredNetworkWeights<Type> > getWeights() const
+        {
+            return weights;
+        }
+
         //NetworkNode *getNode(const string name);
 
         inline int getLayerIndex(const string &layerName)
@@ -137,7 +293,108 @@ namespace NEAT
          */
         NEAT_DLL_EXPORT virtual void update();
 
+        /**
+         * updateBatch: Runs update() on numSamples inputs at once, so each
+         * weight is read once per batch instead of once per sample.
+         * inputValues holds each sample's input in turn: the node values
+         * of every layer that has no source layers, in layer order.
+         * outputValues receives each sample's last layer in turn.  The
+         * network's own node values are left alone.
+         */
+        NEAT_DLL_EXPORT void updateBatch(
+            int numSamples,
+            const Type *inputValues,
+            Type *outputValues
+        );
+
+        /**
+         * getNumInputValues: Returns the number of input values each
+         * sample of updateBatch() takes
+         */
+        NEAT_DLL_EXPORT int getNumInputValues();
+
+        /**
+         * getNumOutputValues: Returns the number of output values each
+         * sample of updateBatch() gives
+         */
+        NEAT_DLL_EXPORT int getNumOutputValues();
+
+        /**
+         * setInputValue: Sets a node of an input layer and adds the change
+         * to the accumulated sums.  Use it with updateFromAccumulator() when
+         * only a few inputs change between updates, as in a game tree
+         * search.
+         */
+        NEAT_DLL_EXPORT void setInputValue(const Node &nodeIndex,Type newValue);
+
+        /**
+         * refreshAccumulator: Recomputes the accumulated sums from the
+         * input values.  setValue(), setLink() and reinitialize() leave the
+         * accumulator to be refreshed on the next updateFromAccumulator().
+         * Calling it at the root of a search keeps rounding errors from
+         * building up over many setInputValue() calls.
+         */
+        NEAT_DLL_EXPORT void refreshAccumulator();
+
+        /**
+         * updateFromAccumulator: The same as update(), but the layers fed
+         * only by input layers are activated straight from the accumulated
+         * sums instead of being multiplied out again
+         */
+        NEAT_DLL_EXPORT void updateFromAccumulator();
+
+        /**
+         * getInputLayerValues: Returns a view to write an input layer's
+         * node values through, instead of one setValue() per node.  It
+         * leaves the accumulator to be refreshed like setValue() does.
+         */
+        NEAT_DLL_EXPORT LayerView<Type> getInputLayerValues(int layerIndex);
+
+        /**
+         * getLayerValues: Returns a view of a layer's node values, which
+         * hold the result of the last update
+         */
+        NEAT_DLL_EXPORT LayerView<const Type> getLayerValues(int layerIndex) const;
+
+        /**
+         * getNumSparseLayerPairs: Returns how many layer pairs are stored
+         * as sparse matrices
+         */
+        NEAT_DLL_EXPORT int getNumSparseLayerPairs();
+
     protected:
+        /**
+         * updateLayer: Computes one layer's node values from its sources
+         */
+        void updateLayer(size_t layerIndex,ActivationAccuracy accuracy);
+
+        /**
+         * multiplyWeights: Runs the kernel for the weights from the
+         * layer's fromLayers[a], in whichever layout they are stored
+         */
+        void multiplyWeights(
+            int layerIndex,
+            int a,
+            int numSamples,
+            const Type *inputs,
+            int inputStride,
+            Type *outputs,
+            int outputStride,
+            bool activate,
+            ActivationAccuracy accuracy
+        );
+
+        /**
+         * makeDense: Moves the weights from the layer's fromLayers[a] back
+         * into layerWeights
+         */
+        void makeDense(int layerIndex,int a);
+
+        /**
+         * getMutableWeights: Copies the weights first if another network
+         * shares them, then returns them for writing
+         */
+        FastLayeredNetworkWeights<Type> &getMutableWeights();
     };
 
 }
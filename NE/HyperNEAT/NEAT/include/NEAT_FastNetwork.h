@@ -6,6 +6,9 @@
 #include "NEAT_NetworkNode.h"
 #include "NEAT_NetworkLink.h"
 #include "NEAT_NetworkIndexedLink.h"
+#include "NEAT_ActivationKernels.h"
+#include "NEAT_IncomingLinkTable.h"
+#include "NEAT_NetworkCompiler.h"
 
 namespace NEAT
 {
@@ -20,13 +23,29 @@ namespace NEAT
     {
         int numNodes;
         int numLinks;
-        map<string,int> nodeNameToIndex;
+
+        /**
+         * nodeNames holds the name of each node by index, and nodeNameOrder
+         * holds the node indices sorted by name for lookups.  nodeNames never
+         * shrinks so that rebind() can reuse its strings, which leaves the
+         * entries past numNodes stale.
+         */
+        vector<string> nodeNames;
+        vector<int> nodeNameOrder;
+
         char *data;
+        size_t dataCapacity;
         Type *nodeValues;
         Type *nodeNewValues;
         ActivationFunction *activationFunctions;
         NetworkIndexedLink<Type> *links;
+
+        /**
+         * nodeLinkMap is only needed to find links by name, so it is built
+         * the first time getLink(fromNodeName,toNodeName) is called
+         */
         map<pair<int,int>,int> nodeLinkMap;
+        bool nodeLinkMapBuilt;
 
         /**
          * numConstantNodes holds the index of the first node that is updated.  All nodes before
@@ -34,6 +53,117 @@ namespace NEAT
          */
         int numConstantNodes;
 
+        /**
+         * activationNodes holds the updated nodes sorted by activation function,
+         * and each of activationGroups covers the nodes that share one function,
+         * so an update runs one activation kernel per group instead of
+         * dispatching on every node.
+         */
+        vector<int> activationNodes;
+        vector<ActivationGroup> activationGroups;
+
+        /**
+         * incomingLinks holds the links into the updated nodes grouped by
+         * destination, which is what the updates walk.  links stays in gene
+         * order for getLink().  linkWeightsChanged is set whenever a link is
+         * handed out or edited, and the next update copies the weights over.
+         */
+        IncomingLinkTable<Type> incomingLinks;
+        bool linkWeightsChanged;
+
+        /**
+         * If the network has no cycles among its updated nodes, feedForwardNodes holds
+         * those nodes in topological order.  feedForwardDepth is the number of synchronous
+         * updates it takes for every node to settle, so any update of at least that many
+         * iterations can be done in a single ordered pass with identical results.
+         * Nodes are ordered by depth and then activation function, and each of
+         * feedForwardGroups covers the nodes of one depth that share a function.
+         */
+        bool feedForward;
+        int feedForwardDepth;
+        vector<int> feedForwardNodes;
+        vector<ActivationGroup> feedForwardGroups;
+
+        /**
+         * Scratch space for evaluateBatch, indexed [node*numSamples+sample]
+         */
+        vector<Type> batchValues;
+        vector<Type> batchNewValues;
+
+        /**
+         * compiled is this network's native code from the NetworkCompiler, or
+         * NULL.  It has the weights folded in, so it is dropped as soon as a
+         * weight may have changed.  Holding it keeps the code loaded after
+         * the NetworkCompiler is deinitialized.
+         */
+        shared_ptr<const CompiledNetwork<Type> > compiled;
+
+        template<class CompilerType>
+        friend class NetworkCompiler;
+
+        /**
+         * Scratch space for building the network.  It keeps its capacity so
+         * rebind() stops allocating once it has seen a genome this large, and
+         * it is not copied with the network.
+         */
+        class BuildScratch
+        {
+        public:
+            vector<pair<int,int> > nodeIDToIndex;
+            vector<int> inDegree;
+            vector<int> outStart;
+            vector<int> outLinks;
+            vector<int> outFill;
+            vector<int> depth;
+            vector<pair<int,int> > nodeKeys;
+        };
+        BuildScratch buildScratch;
+
+        /**
+         * State for backProp and backPropBatch.  The adjacency lists every
+         * link by destination (in*) and by source (out*), in gene order, and
+         * is built by the first training step after the network is built.
+         * The per-link and per-node arrays are indexed [item*numSamples+sample]
+         * for the current minibatch.  velocities holds the momentum of each
+         * link and is dropped with the adjacency when the network is rebuilt.
+         * None of this is copied with the network.
+         */
+        class BackPropScratch
+        {
+        public:
+            bool built;
+            vector<int> inStart;
+            vector<int> inLinks;
+            vector<int> outStart;
+            vector<int> outLinks;
+
+            vector<Type> linkErrors;
+            vector<char> linkTouched;
+            vector<char> nodeMarked;
+            vector<char> linkListed;
+            vector<char> nodeListed;
+            vector<int> touchedLinks;
+            vector<int> markedNodes;
+
+            vector<char> sampleActive;
+            vector<Type> sampleSums;
+            vector<Type> sampleErrors;
+            vector<int> outputNodes;
+            vector<Type> targets;
+
+            vector<Type> hiddenDeltas;
+            vector<Type> outputDeltas;
+            vector<char> hiddenDeltaSet;
+            vector<char> outputDeltaSet;
+            vector<Type> velocities;
+
+            BackPropScratch()
+                    :
+                    built(false)
+            {}
+        };
+        BackPropScratch backPropScratch;
+
     public:
         /**
          *  (Constructor) Create a Network with the inputed toplogy
@@ -75,6 +205,17 @@ namespace NEAT
 
         NEAT_DLL_EXPORT virtual ~FastNetwork();
 
+        /**
+         *  rebind: Rebuilds the network in place for a new genome, as if it
+         *  had been constructed from it.  The network's buffers keep their
+         *  capacity, so rebinding one network to genome after genome stops
+         *  allocating once the genomes stop growing.
+         */
+        NEAT_DLL_EXPORT void rebind(
+            const vector<GeneticNodeGene> &_nodes,
+            const vector<GeneticLinkGene> &_links
+        );
+
         //NetworkNode *getNode(const string name);
 
         /**
@@ -94,16 +235,43 @@ namespace NEAT
         NEAT_DLL_EXPORT void setValue(const string &nodeName,Type newValue);
 
         /**
-         *  getLink: gets the link according to its index when created
+         *  getNodeIndex: Returns the index of the node with the specified
+         *  name, or -1 if the node does not exist.  Look the index up once
+         *  and use getIndexedValue/setIndexedValue in inner loops to avoid
+         *  the name lookup.
+         */
+        NEAT_DLL_EXPORT int getNodeIndex(const string &nodeName);
+
+        /**
+         *  getIndexedValue: gets the value for a node index from getNodeIndex
+         */
+        inline Type getIndexedValue(int nodeIndex) const
+        {
+            return nodeValues[nodeIndex];
+        }
+
+        /**
+         *  setIndexedValue: sets the value for a node index from getNodeIndex
+         */
+        inline void setIndexedValue(int nodeIndex,Type newValue)
+        {
+            nodeValues[nodeIndex] = newValue;
+        }
+
+        /**
+         *  getLink: gets the link according to its index when created.
+         *  Changes to the weight are picked up by the next update, so
+         *  don't hold on to the pointer across updates.
          */
         NetworkIndexedLink<Type> *getLink(int index)
         {
+            linkWeightsChanged=true;
             return &links[index];
         }
 
         /**
          *  getLink: gets the link according to the names
-         *  of it's nodes
+         *  of it's nodes.  The same rules as getLink(index) apply.
          */
         NEAT_DLL_EXPORT NetworkIndexedLink<Type> *getLink(const string &fromNodeName,const string &toNodeName);
 
@@ -119,6 +287,24 @@ namespace NEAT
             return numLinks;
         }
 
+        /**
+         *  isFeedForward: Returns "true" if the network has no recurrent
+         *  connections and can be evaluated in a single pass
+         */
+        inline bool isFeedForward() const
+        {
+            return feedForward;
+        }
+
+        /**
+         *  isCompiled: Returns "true" if updates run the network's compiled
+         *  native code instead of the interpreter
+         */
+        inline bool isCompiled() const
+        {
+            return compiled.get()!=NULL;
+        }
+
         /**
          * reinitialize: This resets the state of the network
          * to its initial state
@@ -133,6 +319,11 @@ namespace NEAT
          * Otherwise, it will update (iterations) times.  If you do not
          * want the extra updates, call dummyActivation() before the first
          * update.
+         * If the network is feed-forward and the number of updates is enough
+         * for the outputs to settle, a single pass in topological order is
+         * done instead, which gives the same values.
+         * If the network has been compiled, the compiled code is run instead
+         * of the interpreter, again with the same values.
          */
         NEAT_DLL_EXPORT void updateFixedIterations(int iterations);
 
@@ -141,15 +332,112 @@ namespace NEAT
             updateFixedIterations(1);
         }
 
+        /**
+         * evaluateBatch: Evaluates the network on numSamples sets of inputs at once.
+         * inputValues[a] points to numSamples values for the node at inputIndices[a],
+         * and outputValues[a] receives numSamples values for the node at
+         * outputIndices[a].  Inputs with an index of -1 are skipped.
+         * Each sample gives the same result as reinitialize(), setting the inputs,
+         * update() and reading the outputs, but the network's own node values are
+         * left untouched.  Node values are stored sample-major so the link and
+         * activation loops run over contiguous samples.  A compiled network runs
+         * its compiled batch update instead, with the same values.
+         */
+        NEAT_DLL_EXPORT void evaluateBatch(
+            int numSamples,
+            const vector<int> &inputIndices,
+            const Type * const *inputValues,
+            const vector<int> &outputIndices,
+            Type * const *outputValues
+        );
+
         NEAT_DLL_EXPORT void print();
 
         NEAT_DLL_EXPORT void clearAllLinkWeights();
 
+        /**
+         * backProp: Does one step of backpropagation towards correctedValues
+         * for the named output nodes, from the network's current node values.
+         * Unless perceptron is set, the links into the nodes that feed the
+         * outputs are trained as well.
+         */
         NEAT_DLL_EXPORT void backProp(const vector<string> &nodeNames,const vector<Type> &correctedValues,bool perceptron);
 
+        /**
+         * backPropBatch: Trains the network on a minibatch of numSamples samples.
+         * The inputs are laid out as for evaluateBatch, and targetValues[a]
+         * points to numSamples targets for the node at outputIndices[a].
+         * Every sample is evaluated and its weight changes are worked out with
+         * the weights from before the batch, as in backProp with the given
+         * learning rate.  The changes are summed over the batch and, if
+         * momentum is non-zero, added to momentum times the previous batch's
+         * changes before being applied.
+         * A batch of one sample with no momentum and a learningRate of 0.5
+         * changes the weights exactly as evaluating that sample and calling
+         * backProp does, for perceptrons and for networks where the nodes
+         * feeding the outputs are not linked to each other.  The network's
+         * own node values are left untouched.
+         */
+        NEAT_DLL_EXPORT void backPropBatch(
+            int numSamples,
+            const vector<int> &inputIndices,
+            const Type * const *inputValues,
+            const vector<int> &outputIndices,
+            const Type * const *targetValues,
+            bool perceptron,
+            Type learningRate,
+            Type momentum
+        );
+
     protected:
         void copyFrom(const FastNetwork &other);
 
+        void reserveData();
+
+        void buildIndexes();
+
+        void buildNodeLinkMap();
+
+        void computeActivationGroups();
+
+        void refreshIncomingLinks();
+
+        void computeFeedForwardPlan();
+
+        void updateFeedForward(bool signedActivation,bool usingTanhSigmoid,ActivationAccuracy accuracy);
+
+        /**
+         * sumBatch: Writes the weighted inputs of node for every sample of a
+         * batch laid out as [node*numSamples+sample]
+         */
+        void sumBatch(int node,const Type *values,Type *nodeBatch,int numSamples);
+
+        /**
+         * runBatch: Does the work of evaluateBatch, leaving every node's
+         * values in batchValues
+         */
+        void runBatch(int numSamples,const vector<int> &inputIndices,const Type * const *inputValues);
+
+        void buildBackPropAdjacency();
+
+        /**
+         * backPropSamples: Works out the weight changes for numSamples
+         * samples whose node values and targets are laid out
+         * [item*numSamples+sample].  With applyNow (and one sample) the
+         * changes go straight into the links in the order backProp has always
+         * made them; otherwise they are summed into hiddenDeltas and
+         * outputDeltas.
+         */
+        void backPropSamples(
+            int numSamples,
+            const Type *values,
+            const vector<int> &outputIndices,
+            const Type *targets,
+            bool perceptron,
+            Type learningRate,
+            bool applyNow
+        );
+
         Type runActivationFunction(Type value,ActivationFunction function,bool signedActivation,bool usingTanhSigmoid);
 
         Type activationFunctionDerivative(Type value,ActivationFunction function);
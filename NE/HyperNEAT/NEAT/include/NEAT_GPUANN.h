@@ -46,6 +46,12 @@ namespace NEAT
         NEAT_DLL_EXPORT virtual void update();
 
     protected:
+        /**
+         * getPackedWeights: Fills packedWeights with the weights into the
+         * layer from its first source layer, one unpadded row per node,
+         * which is the layout the OpenCL kernel reads
+         */
+        void getPackedWeights(int layerIndex,vector<float> &packedWeights);
     };
 
 }
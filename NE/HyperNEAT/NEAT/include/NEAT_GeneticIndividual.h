@@ -8,6 +8,8 @@
 #include "NEAT_Network.h"
 #include "NEAT_ModularNetwork.h"
 #include "NEAT_FastNetwork.h"
+#include "NEAT_NetworkCompiler.h"
+#include "NEAT_Globals.h"
 #ifdef EPLEX_INTERNAL
 #include "NEAT_VectorNetwork.h"
 #include "NEAT_FractalNetwork.h"
@@ -89,6 +91,14 @@ namespace NEAT
         */
         NEAT_DLL_EXPORT void testMutate();
 
+        /**
+         * resolveInnovations: Gives the genes made with provisional IDs
+         * their real IDs, replaying the innovations in the order they were
+         * made, as if they had been made with real IDs on this thread.
+         * The genes are sorted by their new IDs.
+         */
+        NEAT_DLL_EXPORT void resolveInnovations(const InnovationLog &innovations);
+
         NEAT_DLL_EXPORT int getNodesCount() const;
 
         NEAT_DLL_EXPORT GeneticNodeGene *getNode(int index);
@@ -177,10 +187,38 @@ namespace NEAT
 
         NEAT_DLL_EXPORT ModularNetwork spawnPhenotypeStack() const;
 
+        /**
+         * spawnFastPhenotypeStack: Builds a FastNetwork for this individual.
+         * If NetworkCompileThreshold is set, the network runs compiled
+         * native code once the NetworkCompiler has it ready.
+         */
         template<class Type>
         inline FastNetwork<Type> spawnFastPhenotypeStack() const
         {
-            return FastNetwork<Type>(nodes,links);
+            FastNetwork<Type> network(nodes,links);
+
+            if (Globals::getSingleton()->getNetworkCompileThreshold()>0)
+            {
+                NetworkCompiler<Type>::getSingleton()->attach(network);
+            }
+
+            return network;
+        }
+
+        /**
+         * rebindFastPhenotype: Like spawnFastPhenotypeStack, but rebuilds an
+         * existing network in place so its buffers get reused.  Use this
+         * where the same network object is built over and over.
+         */
+        template<class Type>
+        inline void rebindFastPhenotype(FastNetwork<Type> &network) const
+        {
+            network.rebind(nodes,links);
+
+            if (Globals::getSingleton()->getNetworkCompileThreshold()>0)
+            {
+                NetworkCompiler<Type>::getSingleton()->attach(network);
+            }
         }
 
 #ifdef EPLEX_INTERNAL
@@ -203,6 +241,47 @@ namespace NEAT
         NEAT_DLL_EXPORT bool isValid();
 	protected:
     };
+
+    /**
+     * The coefficients of the compatibility formula, read from the
+     * parameters once instead of on every comparison
+     */
+    class CompatibilityCoefficients
+    {
+    public:
+        double disjointCoeff;
+        double excessCoeff;
+        double weightDiffCoeff;
+        double fitnessCoeff;
+
+        NEAT_DLL_EXPORT CompatibilityCoefficients();
+    };
+
+    /**
+     * A snapshot of what getCompatibility() reads from an individual: its
+     * link IDs and weights in the order they are stored, and its fitness.
+     * Comparing two of them walks two flat arrays.
+     */
+    class CompactGenome
+    {
+    public:
+        vector<int> linkIDs;
+        vector<double> linkWeights;
+        double fitness;
+
+        NEAT_DLL_EXPORT CompactGenome();
+
+        NEAT_DLL_EXPORT CompactGenome(const GeneticIndividual &individual);
+
+        /**
+         * getCompatibility: Returns the same value as this individual's
+         * GeneticIndividual::getCompatibility(other)
+         */
+        NEAT_DLL_EXPORT double getCompatibility(
+            const CompactGenome &other,
+            const CompatibilityCoefficients &coefficients
+        ) const;
+    };
 }
 
 #endif
@@ -76,6 +76,12 @@ namespace NEAT
 
         virtual void mutate();
 
+        /**
+         * perturbWeight: Does what mutate() does with a number drawn
+         * ahead of time, randomDouble in [0,1)
+         */
+        void perturbWeight(double mutationPower,double randomDouble);
+
         virtual inline int getID() const
         {
             return ID;
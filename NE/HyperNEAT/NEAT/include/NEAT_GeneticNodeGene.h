@@ -7,6 +7,8 @@
 
 #include "NEAT_Random.h"
 
+#include "NEAT_StringTable.h"
+
 namespace NEAT
 {
     /**
@@ -15,7 +17,11 @@ namespace NEAT
     class NEAT_DLL_EXPORT GeneticNodeGene : public GeneticGene
     {
     protected:
-        string name,type;
+        /**
+         * The name and type are interned in the StringTable, since every
+         * copy of a gene in every generation would otherwise hold its own
+         */
+        const string *name,*type;
 
         /*Greater drawing position means closer to output!*/
         double drawingPosition;
@@ -51,12 +57,12 @@ namespace NEAT
 
         inline const string &getName() const
         {
-            return name;
+            return *name;
         }
 
         inline const string &getType() const
         {
-            return type;
+            return *type;
         }
 
         /*int getLegacyNodeID()
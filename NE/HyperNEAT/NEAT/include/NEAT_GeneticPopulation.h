@@ -27,6 +27,12 @@ namespace NEAT
         //we use a separate vector for extinct species to save CPU.
         vector<shared_ptr<GeneticSpecies> > extinctSpecies;
 
+        /**
+         * speciesByID[id] is the living species with that ID, or NULL.
+         * Species IDs come from one counter, so the vector stays small.
+         */
+        vector<shared_ptr<GeneticSpecies> > speciesByID;
+
         int onGeneration;
     public:
         NEAT_DLL_EXPORT GeneticPopulation();
@@ -63,21 +69,34 @@ namespace NEAT
 
         inline shared_ptr<GeneticSpecies> getSpecies(int id)
         {
-            for (int a=0;a<(int)species.size();a++)
-            {
-                if (species[a]->getID()==id)
-                    return species[a];
-            }
+            if (id>=0 && id<(int)speciesByID.size() && speciesByID[id])
+                return speciesByID[id];
 
             throw CREATE_LOCATEDEXCEPTION_INFO("Tried to get a species which doesn't exist (Maybe it went extinct?)");
         }
 
+        /**
+         * speciate: Puts each individual of the current generation in the
+         * first species whose best individual is compatible with it, or in
+         * a new species.  The comparisons with the species from earlier
+         * generations are done on EvolutionThreads threads, and the result
+         * is the same as doing them one at a time.
+         */
         NEAT_DLL_EXPORT void speciate();
 
         NEAT_DLL_EXPORT void setSpeciesMultipliers();
 
         NEAT_DLL_EXPORT void adjustFitness();
 
+        /**
+         * produceNextGeneration: Makes the next generation from the
+         * current one.  Each species chooses its babies' parents from its
+         * own stream of the run's generator, then the babies are made on
+         * EvolutionThreads threads.  Each baby draws from a stream numbered
+         * by the generation and the baby's index, and its new genes get
+         * their IDs once all the babies are made, in the babies' order, so
+         * the result is the same for any number of threads.
+         */
         NEAT_DLL_EXPORT void produceNextGeneration();
 
         NEAT_DLL_EXPORT void dump(string filename,bool includeGenes,bool doGZ);
@@ -90,6 +109,15 @@ namespace NEAT
         {
             return (int)generations.size();
         }
+
+    protected:
+        /**
+         * makeBabies: Makes a baby from each of the babyParents
+         */
+        void makeBabies(
+            const vector<BabyParents> &babyParents,
+            vector<shared_ptr<GeneticIndividual> > &babies
+        );
     };
 
 }
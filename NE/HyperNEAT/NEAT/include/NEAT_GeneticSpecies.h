@@ -6,6 +6,42 @@
 
 namespace NEAT
 {
+    /**
+     *  The parents chosen for one baby.  With no second parent the baby is
+     *  a copy of the first, mutated if mutate is set.  Choosing parents is
+     *  cheap and draws from the global generator, so it is done in order;
+     *  making the babies is what is worth spreading over threads.
+     */
+    class BabyParents
+    {
+    public:
+        shared_ptr<GeneticIndividual> parent1,parent2;
+        bool mutate;
+
+        BabyParents()
+                :
+                mutate(false)
+        {}
+
+        BabyParents(shared_ptr<GeneticIndividual> _parent1,bool _mutate)
+                :
+                parent1(_parent1),
+                mutate(_mutate)
+        {}
+
+        BabyParents(shared_ptr<GeneticIndividual> _parent1,shared_ptr<GeneticIndividual> _parent2)
+                :
+                parent1(_parent1),
+                parent2(_parent2),
+                mutate(true)
+        {}
+
+        /**
+         * makeBaby: Creates the baby by crossover or by copying
+         */
+        NEAT_DLL_EXPORT shared_ptr<GeneticIndividual> makeBaby() const;
+    };
+
     /*
      * GeneticSpecies: This class is responsible for handling a species: a group of similar individuals
      */
@@ -126,7 +162,10 @@ namespace NEAT
 
         NEAT_DLL_EXPORT void incrementAge();
 
-        NEAT_DLL_EXPORT void makeBabies(vector<shared_ptr<GeneticIndividual> > &babies);
+        /**
+         * makeBabies: Chooses the parents of each of this species' offspring
+         */
+        NEAT_DLL_EXPORT void makeBabies(vector<BabyParents> &babies);
 
         NEAT_DLL_EXPORT void dump(TiXmlElement *speciesElement);
     };
@@ -4,8 +4,11 @@
 #include "NEAT_Defines.h"
 #include "NEAT_STL.h"
 #include "NEAT_Random.h"
+#include "NEAT_InnovationTable.h"
 #include "tinyxmlplus.h"
 
+#include <boost/thread/tss.hpp>
+
 /* #defines */
 #define LAST_GENERATION  (-1)
 
@@ -24,6 +27,18 @@ enum ActivationFunction
 
 extern const char *activationFunctionNames[ACTIVATION_FUNCTION_END];
 
+/**
+ * How closely the network activation kernels follow the reference functions.
+ * EXACT reproduces the sigmoid tables and libm results, FAST uses polynomial
+ * approximations that vectorize.
+ */
+enum ActivationAccuracy
+{
+    ACTIVATION_ACCURACY_EXACT = 0,
+    ACTIVATION_ACCURACY_FAST,
+    ACTIVATION_ACCURACY_END
+};
+
 namespace NEAT
 {
     class Globals
@@ -33,7 +48,25 @@ namespace NEAT
 
         int nodeCounter,linkCounter,speciesCounter;
 
-        vector<shared_ptr<GeneticLinkGene> > linkGenesThisGeneration;
+        /**
+         * linkInnovations maps the nodes of each link made this generation
+         * to its ID, and nodeSplits maps the nodes of each link split this
+         * generation to the ID of the node put in it.  Both are cleared by
+         * clearLinkHistory().  innovationMutex guards them and the node
+         * and link counters, so genes can be made from several threads.
+         */
+        InnovationTable linkInnovations;
+        InnovationTable nodeSplits;
+        boost::mutex innovationMutex;
+
+        /**
+         * A thread that makes genes apart from the others sets these:
+         * getRandom() then draws from the thread's own stream, and new
+         * genes get provisional IDs that are logged for resolving later.
+         * The thread owns both, so they are never deleted here.
+         */
+        boost::thread_specific_ptr<Random> threadRandom;
+        boost::thread_specific_ptr<InnovationLog> threadInnovations;
 
 		StackMap<string,double,4096> parameters;
 
@@ -44,6 +77,21 @@ namespace NEAT
 		bool signedActivation;
 
 		bool useTanhSigmoid;
+
+		ActivationAccuracy activationAccuracy;
+
+		double disjointCoefficient;
+		double excessCoefficient;
+		double weightDifferenceCoefficient;
+		double fitnessCoefficient;
+
+		int networkCompileThreshold;
+
+		int substrateCacheSize;
+
+		double sparseLayerDensity;
+
+		int evolutionThreads;
     public:
         static inline Globals *getSingleton()
         {
@@ -93,6 +141,32 @@ namespace NEAT
 
         NEAT_DLL_EXPORT void assignLinkID(GeneticLinkGene *testLink,bool ignoreHistory=false);
 
+        /**
+         * registerNodeSplit: Returns the ID of the node that was put in the
+         * link from fromNodeID to toNodeID this generation, or if there is
+         * none, records nodeID as that node and returns it
+         */
+        NEAT_DLL_EXPORT int registerNodeSplit(int fromNodeID,int toNodeID,int nodeID);
+
+        /**
+         * createNodeID: Returns a node ID that no gene has yet
+         */
+        NEAT_DLL_EXPORT int createNodeID();
+
+        /**
+         * getLinkInnovationID: Returns the ID of the link made between the
+         * nodes this generation, or if there is none, a new ID for it.
+         * With ignoreHistory set the ID is always new.
+         */
+        NEAT_DLL_EXPORT int getLinkInnovationID(int fromNodeID,int toNodeID,bool ignoreHistory=false);
+
+        /**
+         * setThreadInnovations: Makes the genes this thread creates get
+         * provisional IDs logged in innovations instead of real ones.
+         * Pass NULL to go back to real IDs.
+         */
+        NEAT_DLL_EXPORT void setThreadInnovations(InnovationLog *innovations);
+
         NEAT_DLL_EXPORT void clearLinkHistory();
 
         NEAT_DLL_EXPORT int generateSpeciesID();
@@ -119,11 +193,22 @@ namespace NEAT
 
         NEAT_DLL_EXPORT void initRandom();
 
+        /**
+         * getRandom: Returns the generator set for this thread by
+         * setThreadRandom(), or the global one
+         */
         inline Random &getRandom()
         {
-            return random;
+            Random *streamRandom = threadRandom.get();
+            return streamRandom?*streamRandom:random;
         }
 
+        /**
+         * setThreadRandom: Makes getRandom() return streamRandom on this
+         * thread.  Pass NULL to go back to the global generator.
+         */
+        NEAT_DLL_EXPORT void setThreadRandom(Random *streamRandom);
+
         NEAT_DLL_EXPORT void seedRandom(unsigned int newSeed);
 
         NEAT_DLL_EXPORT void dump(TiXmlElement *root);
@@ -143,6 +228,72 @@ namespace NEAT
 			return useTanhSigmoid;
 		}
 
+		inline ActivationAccuracy getActivationAccuracy()
+		{
+			return activationAccuracy;
+		}
+
+		/**
+		 * getNetworkCompileThreshold: The number of times a genome's FastNetwork
+		 * must be spawned before it is compiled to native code.  0 means never.
+		 */
+		inline int getNetworkCompileThreshold()
+		{
+			return networkCompileThreshold;
+		}
+
+		/**
+		 * getSubstrateCacheSize: The number of populated substrates kept
+		 * for genomes that are evaluated again.  0 means none.
+		 */
+		inline int getSubstrateCacheSize()
+		{
+			return substrateCacheSize;
+		}
+
+		/**
+		 * getSparseLayerDensity: FastLayeredNetwork layer pairs with a
+		 * smaller fraction of nonzero weights than this are stored and run
+		 * as sparse matrices.  0 keeps every layer pair dense.
+		 */
+		inline double getSparseLayerDensity()
+		{
+			return sparseLayerDensity;
+		}
+
+		/**
+		 * The coefficients of the compatibility formula, cached since it
+		 * runs for every pair of individuals compared
+		 */
+		inline double getDisjointCoefficient()
+		{
+			return disjointCoefficient;
+		}
+
+		inline double getExcessCoefficient()
+		{
+			return excessCoefficient;
+		}
+
+		inline double getWeightDifferenceCoefficient()
+		{
+			return weightDifferenceCoefficient;
+		}
+
+		inline double getFitnessCoefficient()
+		{
+			return fitnessCoefficient;
+		}
+
+		/**
+		 * getEvolutionThreads: The number of threads the population uses
+		 * to speciate and to make babies.  The result doesn't depend on it.
+		 */
+		inline int getEvolutionThreads()
+		{
+			return evolutionThreads;
+		}
+
     protected:
         NEAT_DLL_EXPORT Globals();
 
@@ -159,6 +310,33 @@ namespace NEAT
 		void cacheParameters();
     };
 
+    /**
+     *  Makes getRandom() draw from a stream on this thread for as long as
+     *  it is in scope, then goes back to the global generator
+     */
+    class RandomStreamScope
+    {
+    protected:
+        Random streamRandom;
+
+    public:
+        RandomStreamScope(const Random &_streamRandom)
+                :
+                streamRandom(_streamRandom)
+        {
+            Globals::getSingleton()->setThreadRandom(&streamRandom);
+        }
+
+        ~RandomStreamScope()
+        {
+            Globals::getSingleton()->setThreadRandom(NULL);
+        }
+
+    private:
+        RandomStreamScope(const RandomStreamScope &);
+        RandomStreamScope &operator=(const RandomStreamScope &);
+    };
+
 }
 
 #endif
@@ -0,0 +1,122 @@
+#ifndef NEAT_INCOMINGLINKTABLE_H_INCLUDED
+#define NEAT_INCOMINGLINKTABLE_H_INCLUDED
+
+#include "NEAT_NetworkIndexedLink.h"
+
+namespace NEAT
+{
+    /**
+     *  The IncomingLinkTable holds a network's links grouped by destination
+     *  node (compressed sparse rows), with the source nodes and weights in
+     *  separate arrays.  Summing a node's inputs is then a sequential walk
+     *  instead of a scatter-add over the links in gene order.  Within a node
+     *  the links keep their gene order, so sums come out the same.
+     */
+    template<class Type>
+    class IncomingLinkTable
+    {
+    protected:
+        vector<int> rowStart;
+        vector<int> fromNodes;
+        vector<Type> weights;
+
+        /**
+         * linkIndices maps each entry back to its index in the link array,
+         * so the weights can be refreshed after links are edited
+         */
+        vector<int> linkIndices;
+
+    public:
+        /**
+         * build: Groups the links by destination.  Links into nodes below
+         * firstNode are left out.
+         */
+        void build(const NetworkIndexedLink<Type> *links,int numLinks,int numNodes,int firstNode)
+        {
+            rowStart.assign(numNodes+1,0);
+            for (int a=0;a<numLinks;a++)
+            {
+                if (links[a].toNode>=firstNode)
+                {
+                    rowStart[links[a].toNode+1]++;
+                }
+            }
+            for (int a=0;a<numNodes;a++)
+            {
+                rowStart[a+1] += rowStart[a];
+            }
+
+            fromNodes.resize(rowStart[numNodes]);
+            weights.resize(rowStart[numNodes]);
+            linkIndices.resize(rowStart[numNodes]);
+
+            //Stable counting sort, so gene order is kept within a node.
+            //rowStart[node+1] is used as the fill position for node, which
+            //leaves it at the end of the row once every link is placed.
+            for (int a=0;a<numLinks;a++)
+            {
+                if (links[a].toNode>=firstNode)
+                {
+                    rowStart[links[a].toNode+1]--;
+                }
+            }
+            for (int a=0;a<numLinks;a++)
+            {
+                if (links[a].toNode>=firstNode)
+                {
+                    int entry = rowStart[links[a].toNode+1]++;
+                    fromNodes[entry] = links[a].fromNode;
+                    weights[entry] = links[a].weight;
+                    linkIndices[entry] = a;
+                }
+            }
+        }
+
+        /**
+         * refreshWeights: Copies the weights back in from the link array
+         */
+        void refreshWeights(const NetworkIndexedLink<Type> *links)
+        {
+            for (int a=0;a<(int)linkIndices.size();a++)
+            {
+                weights[a] = links[linkIndices[a]].weight;
+            }
+        }
+
+        /**
+         * sum: Returns initialValue plus the weighted inputs of node
+         */
+        inline Type sum(int node,const Type *values,Type initialValue) const
+        {
+            Type total = initialValue;
+            int end = rowStart[node+1];
+            for (int a=rowStart[node];a<end;a++)
+            {
+                total += values[fromNodes[a]]*weights[a];
+            }
+            return total;
+        }
+
+        inline int getRowStart(int node) const
+        {
+            return rowStart[node];
+        }
+
+        inline int getRowEnd(int node) const
+        {
+            return rowStart[node+1];
+        }
+
+        inline int getFromNode(int entry) const
+        {
+            return fromNodes[entry];
+        }
+
+        inline Type getWeight(int entry) const
+        {
+            return weights[entry];
+        }
+    };
+}
+
+#endif // NEAT_INCOMINGLINKTABLE_H_INCLUDED
@@ -0,0 +1,238 @@
+#ifndef NEAT_INNOVATIONTABLE_H_INCLUDED
+#define NEAT_INNOVATIONTABLE_H_INCLUDED
+
+#include "NEAT_Defines.h"
+#include "NEAT_STL.h"
+
+namespace NEAT
+{
+    /**
+     *  An open addressing hash table from a (fromNodeID,toNodeID) pair to
+     *  the ID of the innovation made between those nodes this generation.
+     *  Collisions are resolved by linear probing, and the table doubles
+     *  when it is half full.  clear() keeps the memory for the next
+     *  generation.
+     */
+    class InnovationTable
+    {
+    protected:
+        vector<unsigned long long> keys;
+        vector<int> ids;
+        int numEntries;
+
+    public:
+        InnovationTable()
+                :
+                keys(64,getEmptyKey()),
+                ids(64,-1),
+                numEntries(0)
+        {}
+
+        /**
+         * find: Returns the ID stored for the pair, or -1 if there isn't one
+         */
+        inline int find(int fromNodeID,int toNodeID) const
+        {
+            unsigned long long key = getKey(fromNodeID,toNodeID);
+            size_t mask = keys.size()-1;
+
+            for (size_t slot = getHash(key)&mask;;slot = (slot+1)&mask)
+            {
+                if (keys[slot]==key)
+                {
+                    return ids[slot];
+                }
+                if (keys[slot]==getEmptyKey())
+                {
+                    return -1;
+                }
+            }
+        }
+
+        /**
+         * insert: Stores id for the pair, which must not be stored yet
+         */
+        inline void insert(int fromNodeID,int toNodeID,int id)
+        {
+            if (size_t(numEntries+1)*2>keys.size())
+            {
+                grow();
+            }
+
+            unsigned long long key = getKey(fromNodeID,toNodeID);
+            size_t mask = keys.size()-1;
+            size_t slot = getHash(key)&mask;
+
+            while (keys[slot]!=getEmptyKey())
+            {
+                slot = (slot+1)&mask;
+            }
+
+            keys[slot] = key;
+            ids[slot] = id;
+            numEntries++;
+        }
+
+        inline void clear()
+        {
+            if (numEntries)
+            {
+                std::fill(keys.begin(),keys.end(),getEmptyKey());
+                numEntries=0;
+            }
+        }
+
+        inline int size() const
+        {
+            return numEntries;
+        }
+
+    protected:
+        static inline unsigned long long getEmptyKey()
+        {
+            //Node IDs are never negative, so (-1,-1) is never a real pair
+            return ~0ULL;
+        }
+
+        static inline unsigned long long getKey(int fromNodeID,int toNodeID)
+        {
+            return (((unsigned long long)(unsigned int)fromNodeID)<<32) | (unsigned int)toNodeID;
+        }
+
+        static inline size_t getHash(unsigned long long key)
+        {
+            //The splitmix64 finalizer, so consecutive node IDs spread out
+            key ^= key>>30;
+            key *= 0xbf58476d1ce4e5b9ULL;
+            key ^= key>>27;
+            key *= 0x94d049bb133111ebULL;
+            key ^= key>>31;
+            return size_t(key);
+        }
+
+        inline void grow()
+        {
+            vector<unsigned long long> oldKeys(keys.size()*2,getEmptyKey());
+            vector<int> oldIDs(ids.size()*2,-1);
+            oldKeys.swap(keys);
+            oldIDs.swap(ids);
+
+            size_t mask = keys.size()-1;
+            for (size_t a=0;a<oldKeys.size();a++)
+            {
+                if (oldKeys[a]==getEmptyKey())
+                {
+                    continue;
+                }
+
+                size_t slot = getHash(oldKeys[a])&mask;
+                while (keys[slot]!=getEmptyKey())
+                {
+                    slot = (slot+1)&mask;
+                }
+                keys[slot] = oldKeys[a];
+                ids[slot] = oldIDs[a];
+            }
+        }
+    };
+
+    /**
+     *  The innovations one baby made while its genes were given provisional
+     *  IDs, in the order it made them.  Provisional IDs count up from
+     *  PROVISIONAL_ID_BASE, which is above every real ID, so new genes sort
+     *  after their parents' genes like genes with fresh IDs do.
+     *  GeneticIndividual::resolveInnovations() replays the log to give the
+     *  genes their real IDs.
+     */
+    class InnovationLog
+    {
+    public:
+        enum EventType
+        {
+            EVENT_NEW_NODE = 0,
+            EVENT_NODE_SPLIT,
+            EVENT_NEW_LINK,
+            EVENT_NEW_UNIQUE_LINK
+        };
+
+        enum
+        {
+            PROVISIONAL_ID_BASE = 1<<30
+        };
+
+        /**
+         * id is the provisional ID of the new gene, or for a split, of the
+         * node put in the link from fromNodeID to toNodeID
+         */
+        struct Event
+        {
+            EventType type;
+            int id;
+            int fromNodeID,toNodeID;
+        };
+
+    protected:
+        vector<Event> events;
+        int numProvisionalIDs;
+
+    public:
+        InnovationLog()
+                :
+                numProvisionalIDs(0)
+        {}
+
+        inline int logNode()
+        {
+            return logEvent(EVENT_NEW_NODE,makeProvisionalID(),-1,-1);
+        }
+
+        inline int logNodeSplit(int fromNodeID,int toNodeID,int nodeID)
+        {
+            return logEvent(EVENT_NODE_SPLIT,nodeID,fromNodeID,toNodeID);
+        }
+
+        inline int logLink(int fromNodeID,int toNodeID,bool ignoreHistory)
+        {
+            return logEvent(
+                       ignoreHistory?EVENT_NEW_UNIQUE_LINK:EVENT_NEW_LINK,
+                       makeProvisionalID(),
+                       fromNodeID,
+                       toNodeID
+                   );
+        }
+
+        inline const vector<Event> &getEvents() const
+        {
+            return events;
+        }
+
+        inline int getNumProvisionalIDs() const
+        {
+            return numProvisionalIDs;
+        }
+
+        static inline bool isProvisionalID(int id)
+        {
+            return id>=PROVISIONAL_ID_BASE;
+        }
+
+    protected:
+        inline int makeProvisionalID()
+        {
+            return PROVISIONAL_ID_BASE+numProvisionalIDs++;
+        }
+
+        inline int logEvent(EventType type,int id,int fromNodeID,int toNodeID)
+        {
+            Event event;
+            event.type = type;
+            event.id = id;
+            event.fromNodeID = fromNodeID;
+            event.toNodeID = toNodeID;
+            events.push_back(event);
+            return id;
+        }
+    };
+}
+
+#endif // NEAT_INNOVATIONTABLE_H_INCLUDED
@@ -0,0 +1,264 @@
+#ifndef NEAT_LAYERKERNELS_H_INCLUDED
+#define NEAT_LAYERKERNELS_H_INCLUDED
+
+#include "NEAT_Globals.h"
+
+#include <boost/align/aligned_allocator.hpp>
+
+namespace NEAT
+{
+    enum SimdLevel
+    {
+        SIMD_LEVEL_SCALAR = 0,
+        SIMD_LEVEL_SSE2,
+        SIMD_LEVEL_AVX2,
+        SIMD_LEVEL_AVX512,
+        SIMD_LEVEL_END
+    };
+
+    /**
+     * getSimdLevel: Returns the widest instruction set the layer kernels
+     * use on this machine.  It is detected once.  The NEAT_SIMD environment
+     * variable ("scalar", "sse2", "avx2" or "avx512") can lower it.
+     */
+    NEAT_DLL_EXPORT SimdLevel getSimdLevel();
+
+    /**
+     *  A weight matrix with one row per target node and one column per
+     *  source node.  Rows are padded to a multiple of ROW_ALIGNMENT values
+     *  and the row count to a multiple of ROW_BLOCK.  The padding is always
+     *  zero and the storage is 64 byte aligned, so the kernels only ever
+     *  work on whole, aligned vectors.
+     */
+    template<class Type>
+    class PaddedMatrix
+    {
+    public:
+        enum
+        {
+            ROW_ALIGNMENT=16,
+            ROW_BLOCK=8
+        };
+
+        typedef vector<Type,boost::alignment::aligned_allocator<Type,64> > AlignedVector;
+
+        int numRows,numColumns;
+        int rowStride,paddedRows;
+        AlignedVector values;
+
+        PaddedMatrix()
+                :
+                numRows(0),
+                numColumns(0),
+                rowStride(ROW_ALIGNMENT),
+                paddedRows(0)
+        {}
+
+        PaddedMatrix(int _numRows,int _numColumns)
+                :
+                numRows(_numRows),
+                numColumns(_numColumns),
+                rowStride(getPaddedSize(_numColumns)),
+                paddedRows(((_numRows+ROW_BLOCK-1)/ROW_BLOCK)*ROW_BLOCK),
+                values(size_t(rowStride)*paddedRows,Type(0))
+        {}
+
+        /**
+         * getPaddedSize: Returns the padded length of a vector of size
+         * values, which is never 0
+         */
+        static inline int getPaddedSize(int size)
+        {
+            return max(1,(size+ROW_ALIGNMENT-1)/ROW_ALIGNMENT)*ROW_ALIGNMENT;
+        }
+
+        inline Type &operator()(int row,int column)
+        {
+            return values[size_t(row)*rowStride+column];
+        }
+
+        inline const Type &operator()(int row,int column) const
+        {
+            return values[size_t(row)*rowStride+column];
+        }
+    };
+
+    /**
+     *  A weight matrix in compressed sparse row form: row r's nonzero
+     *  weights are values[rowStarts[r]..rowStarts[r+1]) and sit in
+     *  columns[] of the same range, in increasing order.  There are
+     *  paddedRows rows like the PaddedMatrix it came from, so it writes the
+     *  same outputs.
+     */
+    template<class Type>
+    class SparseMatrix
+    {
+    public:
+        int numRows,numColumns;
+        int paddedRows;
+        vector<int> rowStarts;
+        vector<int> columns;
+        vector<Type> values;
+
+        SparseMatrix()
+                :
+                numRows(0),
+                numColumns(0),
+                paddedRows(0),
+                rowStarts(1,0)
+        {}
+
+        /**
+         * (Constructor) Keeps the nonzero weights of dense
+         */
+        SparseMatrix(const PaddedMatrix<Type> &dense)
+                :
+                numRows(dense.numRows),
+                numColumns(dense.numColumns),
+                paddedRows(dense.paddedRows)
+        {
+            rowStarts.reserve(paddedRows+1);
+            rowStarts.push_back(0);
+            for (int row=0;row<paddedRows;row++)
+            {
+                for (int column=0;column<numColumns;column++)
+                {
+                    if (dense(row,column)!=Type(0))
+                    {
+                        columns.push_back(column);
+                        values.push_back(dense(row,column));
+                    }
+                }
+                rowStarts.push_back(int(values.size()));
+            }
+        }
+
+        /**
+         * find: Returns the stored weight at (row,column), or NULL if that
+         * weight is zero and not stored
+         */
+        inline Type *find(int row,int column)
+        {
+            vector<int>::iterator begin = columns.begin()+rowStarts[row];
+            vector<int>::iterator end = columns.begin()+rowStarts[row+1];
+            vector<int>::iterator it = lower_bound(begin,end,column);
+
+            if (it==end || *it!=column)
+            {
+                return NULL;
+            }
+
+            return &values[it-columns.begin()];
+        }
+
+        inline const Type *find(int row,int column) const
+        {
+            vector<int>::const_iterator begin = columns.begin()+rowStarts[row];
+            vector<int>::const_iterator end = columns.begin()+rowStarts[row+1];
+            vector<int>::const_iterator it = lower_bound(begin,end,column);
+
+            if (it==end || *it!=column)
+            {
+                return NULL;
+            }
+
+            return &values[it-columns.begin()];
+        }
+
+        /**
+         * expand: Writes the weights into dense, which must be all zero
+         * and have the same size
+         */
+        inline void expand(PaddedMatrix<Type> &dense) const
+        {
+            for (int row=0;row<paddedRows;row++)
+            {
+                for (int a=rowStarts[row];a<rowStarts[row+1];a++)
+                {
+                    dense(row,columns[a]) = values[a];
+                }
+            }
+        }
+    };
+
+    /**
+     * getWeightDensity: Returns the fraction of weights that are nonzero
+     */
+    template<class Type>
+    NEAT_DLL_EXPORT double getWeightDensity(const PaddedMatrix<Type> &weights);
+
+    /**
+     * activateLayer: Applies the signed sigmoid to count values, the same
+     * way multiplyLayer does when activate is set.  values must be 64 byte
+     * aligned and count a multiple of ROW_ALIGNMENT.
+     */
+    template<class Type>
+    NEAT_DLL_EXPORT void activateLayer(
+        Type *values,
+        int count,
+        ActivationAccuracy accuracy
+    );
+
+    /**
+     * multiplyLayer: Adds weights*input to the first paddedRows values of
+     * output, and if activate is set, applies the signed sigmoid to them.
+     * input holds rowStride values with zeros past the source nodes.
+     * input and output must be 64 byte aligned.
+     *
+     * Several rows are done at once, over blocks of columns that stay in
+     * the L1 cache, with the widest instruction set getSimdLevel() allows.
+     * The sums are reassociated, so they can differ from a sequential sum
+     * in the last bits.  For float networks at ACTIVATION_ACCURACY_FAST the
+     * sigmoid is computed in the vector registers with a polynomial exp.
+     * Otherwise it uses exp() and is the same as FastLayeredNetwork's
+     * original activation.
+     */
+    template<class Type>
+    NEAT_DLL_EXPORT void multiplyLayer(
+        const PaddedMatrix<Type> &weights,
+        const Type *input,
+        Type *output,
+        bool activate,
+        ActivationAccuracy accuracy
+    );
+
+    /**
+     * multiplyLayerBatch: multiplyLayer for numSamples inputs at once.
+     * Sample s reads input from inputs+s*inputStride and writes output to
+     * outputs+s*outputStride.  The strides must be multiples of
+     * ROW_ALIGNMENT and at least rowStride and paddedRows.  Each block of
+     * weights is used by every sample before moving on, so the weights are
+     * read from memory once per batch instead of once per sample.
+     */
+    template<class Type>
+    NEAT_DLL_EXPORT void multiplyLayerBatch(
+        const PaddedMatrix<Type> &weights,
+        int numSamples,
+        const Type *inputs,
+        int inputStride,
+        Type *outputs,
+        int outputStride,
+        bool activate,
+        ActivationAccuracy accuracy
+    );
+
+    /**
+     * multiplySparseLayerBatch: multiplyLayerBatch for a sparse matrix.
+     * The work is proportional to the number of nonzero weights.  The
+     * vector kernels gather the inputs each row needs, so they are only
+     * worth it over the dense ones when most weights are zero.
+     */
+    template<class Type>
+    NEAT_DLL_EXPORT void multiplySparseLayerBatch(
+        const SparseMatrix<Type> &weights,
+        int numSamples,
+        const Type *inputs,
+        int inputStride,
+        Type *outputs,
+        int outputStride,
+        bool activate,
+        ActivationAccuracy accuracy
+    );
+}
+
+#endif // NEAT_LAYERKERNELS_H_INCLUDED
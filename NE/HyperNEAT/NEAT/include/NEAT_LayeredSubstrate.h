@@ -26,12 +26,36 @@ namespace NEAT
         int maxDeltaLength;
         int maxConnectionLength;
 
+        /**
+         * numThreads is the number of threads that query the CPPN while
+         * populating the substrate.  The weights are the same for any number.
+         */
+        int numThreads;
+
+        /**
+         * adaptiveSubstrate turns on quadtree sampling of the target
+         * layers.  The targets of each source node are split into
+         * quadrants, and a quadrant is only split again where the CPPN
+         * outputs at the centers of its children vary by more than
+         * adaptiveVarianceThreshold.  Links are expressed at the centers of
+         * the quadrants that aren't split, so smooth regions of the weight
+         * pattern get a few links instead of one per node.  The first
+         * adaptiveInitialDepth levels are always split.
+         */
+        bool adaptiveSubstrate;
+        int adaptiveInitialDepth;
+        double adaptiveVarianceThreshold;
+
         LayeredSubstrateInfo()
             :
         normalize(true),
         useOldOutputNames(false),
         maxDeltaLength(1000000),
-        maxConnectionLength(1000000)
+        maxConnectionLength(1000000),
+        numThreads(1),
+        adaptiveSubstrate(false),
+        adaptiveInitialDepth(2),
+        adaptiveVarianceThreshold(0.03)
         {
         }
     };
@@ -55,6 +79,29 @@ namespace NEAT
 
         NodeMap nameLookup;
 
+        /**
+         * The CPPN is rebound to each individual instead of being rebuilt,
+         * so its buffers are reused from one populateSubstrate() to the next
+         */
+        NEAT::FastNetwork<NetworkDataType> cppn;
+
+        /**
+         * Copies of the CPPN for the extra threads when numThreads>1
+         */
+        vector<NEAT::FastNetwork<NetworkDataType> > threadCPPNs;
+
+        /**
+         * The substrate's links grouped by destination node (compressed
+         * sparse rows).  Nodes are numbered layer by layer and row by row,
+         * starting at layerNodeOffsets[z] for layer z, which is also the
+         * order Node sorts in.  The arrays keep their capacity from one
+         * populateSubstrate() to the next.
+         */
+        vector<int> layerNodeOffsets;
+        vector<int> incomingLinkStart;
+        vector<Node> incomingLinkSources;
+        vector<NetworkDataType> incomingLinkWeights;
+
         vector< JGTL::Vector2<int> > layerSizes;
         vector< JGTL::Vector2<int> > layerValidSizes;
         vector< string > layerNames;
@@ -63,6 +110,16 @@ namespace NEAT
 		bool normalize;
         int maxDeltaLength;
         int maxConnectionLength;
+        int numThreads;
+        bool adaptiveSubstrate;
+        int adaptiveInitialDepth;
+        double adaptiveVarianceThreshold;
+
+        /**
+         * The CPPN coordinate of every column and row of each layer
+         */
+        vector< vector<NetworkDataType> > layerXCoordinates;
+        vector< vector<NetworkDataType> > layerYCoordinates;
 
         bool useOldOutputNames;
 
@@ -74,6 +131,11 @@ namespace NEAT
 
 		NEAT_DLL_EXPORT void setLayerInfo(LayeredSubstrateInfo layerInfo);
 
+        /**
+         * populateSubstrate: Sets the link weights from individual's CPPN.
+         * When SubstrateCacheSize is above 0, the weights of an individual
+         * seen recently are taken from the SubstrateCache instead.
+         */
 		NEAT_DLL_EXPORT void populateSubstrate(
 			shared_ptr<NEAT::GeneticIndividual> individual
 			);
@@ -105,6 +167,27 @@ namespace NEAT
 
 		NEAT_DLL_EXPORT void setValue(const Node &node,NetworkDataType _value);
 
+		/**
+		 * setInputValue: setValue() for an input layer node that also
+		 * updates the network's accumulator (see
+		 * FastLayeredNetwork::setInputValue)
+		 */
+		NEAT_DLL_EXPORT void setInputValue(const Node &node,NetworkDataType _value);
+
+		/**
+		 * getInputLayer: Returns a view to write input layer z through,
+		 * addressed like setValue() addresses its nodes.  It is meant for
+		 * filling a whole board at once, row by row.  Like getOutputLayer(),
+		 * it covers only the valid nodes, not the padding around them.
+		 */
+		NEAT_DLL_EXPORT LayerView<NetworkDataType> getInputLayer(int z);
+
+		/**
+		 * getOutputLayer: Returns a view of layer z's node values after an
+		 * update, addressed like getValue() addresses its nodes
+		 */
+		NEAT_DLL_EXPORT LayerView<const NetworkDataType> getOutputLayer(int z);
+
 		inline int getNumLayers()
 		{
 			return (int)layerSizes.size();
@@ -160,6 +243,21 @@ namespace NEAT
         }
 		
 	protected:
+        /**
+         * buildSubstrate: Queries individual's CPPN for every link weight
+         * and builds the network from them
+         */
+		void buildSubstrate(
+			shared_ptr<NEAT::GeneticIndividual> individual
+			);
+
+        /**
+         * getSubstrateSignature: Returns the key the SubstrateCache uses
+         * for individual on this substrate
+         */
+		string getSubstrateSignature(
+			shared_ptr<NEAT::GeneticIndividual> individual
+			);
 	};
 }
 
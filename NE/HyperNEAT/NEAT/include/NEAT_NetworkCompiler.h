@@ -0,0 +1,205 @@
+#ifndef NEAT_NETWORKCOMPILER_H_INCLUDED
+#define NEAT_NETWORKCOMPILER_H_INCLUDED
+
+#include "NEAT_Defines.h"
+#include "NEAT_STL.h"
+
+#include <deque>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace NEAT
+{
+    template<class Type>
+    class FastNetwork;
+
+    /**
+     *  A FastNetwork compiled to native code.  update does the same work as
+     *  FastNetwork::updateFixedIterations for count updates, and updateBatch
+     *  the same work as FastNetwork::evaluateBatch on values laid out
+     *  [node*numSamples+sample], with the activation settings below baked
+     *  in.  The shared object it was loaded from is unloaded when it is
+     *  destroyed, so it is only handed out through shared_ptrs.
+     */
+    template<class Type>
+    class CompiledNetwork
+    {
+    public:
+        typedef void (*UpdateFunction)(
+            Type *nodeValues,
+            int count,
+            const double *signedSigmoidTable,
+            const double *unsignedSigmoidTable
+        );
+
+        typedef void (*BatchUpdateFunction)(
+            Type *batchValues,
+            int numSamples,
+            int count,
+            const double *signedSigmoidTable,
+            const double *unsignedSigmoidTable
+        );
+
+        UpdateFunction update;
+        BatchUpdateFunction updateBatch;
+        bool signedActivation;
+        bool usingTanhSigmoid;
+        void *library;
+
+        CompiledNetwork()
+                :
+                update(NULL),
+                updateBatch(NULL),
+                signedActivation(false),
+                usingTanhSigmoid(false),
+                library(NULL)
+        {}
+
+        NEAT_DLL_EXPORT ~CompiledNetwork();
+
+    protected:
+        //Copies would unload the library twice
+        CompiledNetwork(const CompiledNetwork<Type> &other);
+        CompiledNetwork<Type> &operator=(const CompiledNetwork<Type> &other);
+    };
+
+    /**
+     *  The NetworkCompiler turns FastNetworks into straight-line C++ with the
+     *  weights folded in and the activation functions inlined, builds them
+     *  into shared objects with the system compiler and loads them with
+     *  dlopen.  Networks are keyed by a hash of their structure and weights,
+     *  so every spawn of the same genome shares one compiled version.
+     *
+     *  Compilation happens on a background thread.  attach() never waits for
+     *  it: a network spawned before its code is ready keeps running
+     *  interpreted.  Only genomes spawned at least NetworkCompileThreshold
+     *  times are compiled, so the one-off networks of a generation don't
+     *  flood the compiler.
+     *
+     *  The compiler is "c++" unless the NEAT_CXX environment variable says
+     *  otherwise.  The generated code gives the same values as the
+     *  interpreter as long as the library itself is built without FMA
+     *  contraction or -ffast-math.  This is only available where dlopen is;
+     *  elsewhere attach() does nothing.
+     */
+    template<class Type>
+    class NetworkCompiler
+    {
+    protected:
+        NEAT_DLL_EXPORT static NetworkCompiler<Type> *singleton;
+
+        enum EntryState
+        {
+            ENTRY_COUNTING=0,
+            ENTRY_PENDING,
+            ENTRY_READY,
+            ENTRY_FAILED
+        };
+
+        class Entry
+        {
+        public:
+            EntryState state;
+            int spawns;
+            string signature;
+            string source;
+            shared_ptr<CompiledNetwork<Type> > compiled;
+
+            Entry()
+                    :
+                    state(ENTRY_COUNTING),
+                    spawns(0)
+            {}
+        };
+
+        map<unsigned long long,Entry> entries;
+        std::deque<unsigned long long> pending;
+        int compiling;
+
+        boost::mutex entriesMutex;
+        boost::condition_variable pendingCondition;
+        boost::condition_variable idleCondition;
+        boost::thread *worker;
+        bool stopping;
+
+        /**
+         * disabled is set after the first failed build, since a missing or
+         * broken compiler would fail on every network
+         */
+        bool disabled;
+
+        string workingDirectory;
+
+        int numCompiled;
+
+    public:
+        NEAT_DLL_EXPORT static NetworkCompiler<Type> *getSingleton();
+
+        /**
+         * deinit: Stops the background thread, drops the compiled code and
+         * removes the working directory.  Networks that use compiled code
+         * keep it loaded until they let go of it.
+         */
+        NEAT_DLL_EXPORT static void deinit();
+
+        /**
+         * attach: Counts a spawn of network and, if its compiled version is
+         * ready, makes network use it.  Otherwise the network is queued for
+         * compilation once it has been spawned often enough.
+         */
+        NEAT_DLL_EXPORT void attach(FastNetwork<Type> &network);
+
+        /**
+         * waitForPending: Blocks until every queued network has been built
+         */
+        NEAT_DLL_EXPORT void waitForPending();
+
+        /**
+         * getNumCompiled: Returns the number of networks that have been
+         * compiled and loaded
+         */
+        NEAT_DLL_EXPORT int getNumCompiled();
+
+        /**
+         * generateSource: Returns the C++ source for network's update.  The
+         * generated functions are called neatUpdateNetwork and
+         * neatUpdateNetworkBatch.
+         */
+        NEAT_DLL_EXPORT string generateSource(
+            const FastNetwork<Type> &network,
+            bool signedActivation,
+            bool usingTanhSigmoid
+        );
+
+    protected:
+        NetworkCompiler();
+
+        virtual ~NetworkCompiler();
+
+        string getSignature(
+            const FastNetwork<Type> &network,
+            bool signedActivation,
+            bool usingTanhSigmoid
+        );
+
+        /**
+         * writeUpdate: Writes the statements that update the node values
+         * count times.  Node n is read and written as values[n<stride>].
+         */
+        void writeUpdate(
+            ostream &out,
+            const FastNetwork<Type> &network,
+            bool signedActivation,
+            bool usingTanhSigmoid,
+            const string &stride,
+            const string &indent
+        );
+
+        void compileLoop();
+
+        bool compile(unsigned long long hash,Entry &entry);
+    };
+}
+
+#endif // NEAT_NETWORKCOMPILER_H_INCLUDED
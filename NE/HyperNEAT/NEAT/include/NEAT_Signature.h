@@ -0,0 +1,48 @@
+#ifndef NEAT_SIGNATURE_H_INCLUDED
+#define NEAT_SIGNATURE_H_INCLUDED
+
+#include "NEAT_STL.h"
+
+namespace NEAT
+{
+    /**
+     *  Signatures are byte strings that describe everything a cached result
+     *  depends on.  Caches look entries up by the hash of the signature and
+     *  compare the whole signature before sharing anything.
+     */
+
+    /**
+     * appendBytes: Appends the raw bytes of value to signature
+     */
+    template<class Type>
+    inline void appendBytes(string &signature,const Type &value)
+    {
+        signature.append((const char*)&value,sizeof(Type));
+    }
+
+    /**
+     * appendString: Appends a string to signature, length first so that
+     * consecutive strings can't run into each other
+     */
+    inline void appendString(string &signature,const string &value)
+    {
+        appendBytes(signature,int(value.length()));
+        signature.append(value);
+    }
+
+    /**
+     * hashSignature: 64-bit FNV-1a
+     */
+    inline unsigned long long hashSignature(const string &signature)
+    {
+        unsigned long long hash = 14695981039346656037ULL;
+        for (int a=0;a<(int)signature.size();a++)
+        {
+            hash ^= (unsigned char)signature[a];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+}
+
+#endif // NEAT_SIGNATURE_H_INCLUDED
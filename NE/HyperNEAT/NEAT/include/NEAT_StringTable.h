@@ -0,0 +1,31 @@
+#ifndef NEAT_STRINGTABLE_H_INCLUDED
+#define NEAT_STRINGTABLE_H_INCLUDED
+
+#include "NEAT_Defines.h"
+#include "NEAT_STL.h"
+
+namespace NEAT
+{
+    /**
+     *  Interns the names and types of node genes.  Each distinct string is
+     *  stored once for the life of the program and genes keep a pointer to
+     *  it, so copying a gene copies no string data.  Two interned strings
+     *  are equal exactly when their pointers are.
+     */
+    class StringTable
+    {
+    public:
+        /**
+         * intern: Returns the table's copy of value.  It is safe to call
+         * from several threads.
+         */
+        NEAT_DLL_EXPORT static const string *intern(const string &value);
+
+        /**
+         * getNumStrings: Returns how many distinct strings are interned
+         */
+        NEAT_DLL_EXPORT static int getNumStrings();
+    };
+}
+
+#endif // NEAT_STRINGTABLE_H_INCLUDED
@@ -0,0 +1,87 @@
+#ifndef NEAT_SUBSTRATECACHE_H_INCLUDED
+#define NEAT_SUBSTRATECACHE_H_INCLUDED
+
+#include "NEAT_Defines.h"
+#include "NEAT_STL.h"
+
+#include "NEAT_FastLayeredNetwork.h"
+
+#include <list>
+
+#include <boost/thread/mutex.hpp>
+
+namespace NEAT
+{
+    /**
+     *  The SubstrateCache keeps the populated networks of recently seen
+     *  substrates, so genomes that come back unchanged (elites, champions,
+     *  re-evaluations) don't have to query their CPPN again.  Entries are
+     *  keyed by a signature of the CPPN genes, the substrate layout and the
+     *  activation settings, and the least recently used entry is dropped
+     *  once there are more than SubstrateCacheSize of them.
+     *
+     *  One cache is shared by every thread.  The cached networks are never
+     *  changed, and find() hands out copies.  The copies share the cached
+     *  weights, so a hit only costs the node values.
+     */
+    template<class Type>
+    class SubstrateCache
+    {
+    protected:
+        NEAT_DLL_EXPORT static SubstrateCache<Type> *singleton;
+
+        class Entry
+        {
+        public:
+            string signature;
+            shared_ptr<const FastLayeredNetwork<Type> > network;
+            std::list<unsigned long long>::iterator lruPosition;
+        };
+
+        map<unsigned long long,Entry> entries;
+
+        /**
+         * lru holds the keys of entries, most recently used first
+         */
+        std::list<unsigned long long> lru;
+
+        boost::mutex entriesMutex;
+
+        int hits;
+        int misses;
+
+    public:
+        NEAT_DLL_EXPORT static SubstrateCache<Type> *getSingleton();
+
+        NEAT_DLL_EXPORT static void deinit();
+
+        /**
+         * find: If a network is cached for signature, copies it into
+         * network and returns "true"
+         */
+        NEAT_DLL_EXPORT bool find(const string &signature,FastLayeredNetwork<Type> &network);
+
+        /**
+         * insert: Caches network for signature, dropping the least
+         * recently used entries if the cache is full
+         */
+        NEAT_DLL_EXPORT void insert(const string &signature,const FastLayeredNetwork<Type> &network);
+
+        NEAT_DLL_EXPORT void clear();
+
+        NEAT_DLL_EXPORT int getHits();
+
+        NEAT_DLL_EXPORT int getMisses();
+
+        NEAT_DLL_EXPORT int getNumEntries();
+
+    protected:
+        SubstrateCache();
+
+        virtual ~SubstrateCache();
+
+        void trim(int capacity);
+    };
+}
+
+#endif // NEAT_SUBSTRATECACHE_H_INCLUDED
@@ -0,0 +1,461 @@
+#include "NEAT_Defines.h"
+
+#include "NEAT_ActivationKernels.h"
+
+namespace NEAT
+{
+    extern double signedSigmoidTable[6001];
+    extern double unsignedSigmoidTable[6001];
+
+    /*
+     * The exact functors below must stay in step with
+     * FastNetwork::runActivationFunction.  Each one is a plain inline
+     * operator() so the loops in applyKernel are free of dispatch and the
+     * compiler can vectorize the ones that don't touch a table.
+     */
+
+    template<class Type>
+    struct SignedTableSigmoid
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            //Written so NaN takes the exp() path instead of indexing the table
+            if (!(tmpVal>=-2.9 && tmpVal<=2.9))
+            {
+                return (Type)( ((1.0 / (1+exp(-tmpVal))) - 0.5)*2.0 );
+            }
+            return (Type)signedSigmoidTable[int(tmpVal*1000.0)+3000];
+        }
+    };
+
+    template<class Type>
+    struct UnsignedTableSigmoid
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            if (!(tmpVal>=-2.9 && tmpVal<=2.9))
+            {
+                return 1 / (1+exp(-tmpVal));
+            }
+            return (Type)unsignedSigmoidTable[int(tmpVal*1000.0)+3000];
+        }
+    };
+
+    template<class Type>
+    struct SignedTanhSigmoid
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            return 2 / (1 + exp(-2 * tmpVal)) - 1;
+        }
+    };
+
+    template<class Type>
+    struct UnsignedTanhSigmoid
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            return (1 + exp(-2 * tmpVal));
+        }
+    };
+
+    template<class Type>
+    struct SignedSin
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            return sin(tmpVal);
+        }
+    };
+
+    template<class Type>
+    struct UnsignedSin
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            return (sin(tmpVal)+1)/2;
+        }
+    };
+
+    template<class Type>
+    struct SignedCos
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            return cos(tmpVal);
+        }
+    };
+
+    template<class Type>
+    struct UnsignedCos
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            return (cos(tmpVal)+1)/2;
+        }
+    };
+
+    template<class Type>
+    struct Gaussian
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            return exp(-pow(tmpVal,2));
+        }
+    };
+
+    template<class Type>
+    struct Square
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            return tmpVal*tmpVal;
+        }
+    };
+
+    template<class Type>
+    struct SignedAbsRoot
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            Type root = sqrt(fabs(tmpVal));
+            return (tmpVal<0.0) ? -root : root;
+        }
+    };
+
+    template<class Type>
+    struct UnsignedAbsRoot
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            return sqrt(fabs(tmpVal));
+        }
+    };
+
+    template<class Type>
+    struct SignedLinear
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            return min(max(tmpVal,(Type)-3.0),(Type)3.0) / (Type)3.0;
+        }
+    };
+
+    template<class Type>
+    struct UnsignedLinear
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            return ((min(max(tmpVal,(Type)-3.0),(Type)3.0) / (Type)3.0) + 1) / (Type)2.0;
+        }
+    };
+
+    template<class Type>
+    struct SignedOnesCompliment
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            Type tmpVal2 = (Type)min(1.0,max(-1.0,tmpVal/3.0));
+            if (tmpVal>-0.1)
+            {
+                return (Type)1.0-tmpVal2;
+            }
+            return ((Type)-1.0) - tmpVal;
+        }
+    };
+
+    template<class Type>
+    struct UnsignedOnesCompliment
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            Type tmpVal2 = (Type)min(1.0,max(0.0,tmpVal/3.0));
+            return ((Type)1.0)-tmpVal2;
+        }
+    };
+
+    /*
+     * Fast approximations.  These are evaluated in single precision with no
+     * branches or table lookups so they vectorize.
+     */
+
+    /**
+     * fastExp: e^x as 2^i * 2^f with i=round(x*log2(e)), |f|<=0.5 and a
+     * degree 6 polynomial for 2^f.  Relative error is below 2e-7.
+     */
+    inline float fastExp(float x)
+    {
+        //Clamp so the result stays a normal float
+        x = (x<-87.0f) ? -87.0f : x;
+        x = (x>87.0f) ? 87.0f : x;
+
+        float t = x*1.44269504f;
+        //t is within (-126,126) so the shift makes it positive and the cast rounds
+        int i = int(t+126.5f)-126;
+        float f = t-float(i);
+
+        float p = 1.0f + f*(0.693147181f + f*(0.240226507f + f*(0.0555041087f +
+                  f*(0.00961812911f + f*(0.00133335581f + f*0.000154035304f)))));
+
+        int bits = (i+127)<<23;
+        float scale;
+        memcpy(&scale,&bits,sizeof(float));
+        return p*scale;
+    }
+
+    /**
+     * fastSin: Reduces x to [-pi/2,pi/2] and uses the degree 11 Taylor
+     * polynomial.  Absolute error is below 1e-6 for |x| up to 1e4.
+     */
+    inline float fastSin(float x)
+    {
+        //Keeps the cast below in range
+        x = (x<-1e6f) ? -1e6f : x;
+        x = (x>1e6f) ? 1e6f : x;
+
+        //Reduce to [-pi,pi].  2*pi is split in three parts whose leading ones
+        //have few enough bits that k*part is exact (Cody-Waite).
+        float k = float(int(x*0.159154943f + ((x<0.0f) ? -0.5f : 0.5f)));
+        float r = ((x - k*6.28125f) - k*1.93500519e-3f) - k*3.01991605e-7f;
+
+        //Reflect into [-pi/2,pi/2]
+        r = (r>1.57079637f) ? (3.14159274f-r) : r;
+        r = (r<-1.57079637f) ? (-3.14159274f-r) : r;
+
+        float r2 = r*r;
+        return r*(1.0f + r2*(-1.66666667e-1f + r2*(8.33333333e-3f + r2*(-1.98412698e-4f +
+               r2*(2.75573192e-6f + r2*-2.50521084e-8f)))));
+    }
+
+    template<class Type>
+    struct FastSignedSigmoid
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            return (Type)(2.0f / (1.0f + fastExp(-float(tmpVal))) - 1.0f);
+        }
+    };
+
+    template<class Type>
+    struct FastUnsignedSigmoid
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            return (Type)(1.0f / (1.0f + fastExp(-float(tmpVal))));
+        }
+    };
+
+    template<class Type>
+    struct FastSignedTanhSigmoid
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            return (Type)(2.0f / (1.0f + fastExp(-2.0f*float(tmpVal))) - 1.0f);
+        }
+    };
+
+    template<class Type>
+    struct FastUnsignedTanhSigmoid
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            return (Type)(1.0f + fastExp(-2.0f*float(tmpVal)));
+        }
+    };
+
+    template<class Type>
+    struct FastSignedSin
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            return (Type)fastSin(float(tmpVal));
+        }
+    };
+
+    template<class Type>
+    struct FastUnsignedSin
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            return (Type)((fastSin(float(tmpVal))+1.0f)*0.5f);
+        }
+    };
+
+    template<class Type>
+    struct FastSignedCos
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            return (Type)fastSin(float(tmpVal)+1.57079637f);
+        }
+    };
+
+    template<class Type>
+    struct FastUnsignedCos
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            return (Type)((fastSin(float(tmpVal)+1.57079637f)+1.0f)*0.5f);
+        }
+    };
+
+    template<class Type>
+    struct FastGaussian
+    {
+        inline Type operator()(Type tmpVal) const
+        {
+            float value = float(tmpVal);
+            return (Type)fastExp(-value*value);
+        }
+    };
+
+    template<class Type,class Function>
+    inline void applyKernel(
+        const Function &function,
+        const int *indices,
+        int count,
+        const Type *input,
+        Type *output
+        )
+    {
+        if (indices)
+        {
+            for (int a=0;a<count;a++)
+            {
+                int index = indices[a];
+                output[index] = function(input[index]);
+            }
+        }
+        else
+        {
+            for (int a=0;a<count;a++)
+            {
+                output[a] = function(input[a]);
+            }
+        }
+    }
+
+    template<class Type>
+    void runActivationKernel(
+        ActivationFunction function,
+        const int *indices,
+        int count,
+        const Type *input,
+        Type *output,
+        bool signedActivation,
+        bool usingTanhSigmoid,
+        ActivationAccuracy accuracy
+        )
+    {
+        bool fast = (accuracy==ACTIVATION_ACCURACY_FAST);
+
+        switch (function)
+        {
+        case ACTIVATION_FUNCTION_SIGMOID:
+            if (signedActivation)
+            {
+                if (usingTanhSigmoid)
+                {
+                    if (fast)
+                        applyKernel(FastSignedTanhSigmoid<Type>(),indices,count,input,output);
+                    else
+                        applyKernel(SignedTanhSigmoid<Type>(),indices,count,input,output);
+                }
+                else
+                {
+                    if (fast)
+                        applyKernel(FastSignedSigmoid<Type>(),indices,count,input,output);
+                    else
+                        applyKernel(SignedTableSigmoid<Type>(),indices,count,input,output);
+                }
+            }
+            else
+            {
+                if (usingTanhSigmoid)
+                {
+                    if (fast)
+                        applyKernel(FastUnsignedTanhSigmoid<Type>(),indices,count,input,output);
+                    else
+                        applyKernel(UnsignedTanhSigmoid<Type>(),indices,count,input,output);
+                }
+                else
+                {
+                    if (fast)
+                        applyKernel(FastUnsignedSigmoid<Type>(),indices,count,input,output);
+                    else
+                        applyKernel(UnsignedTableSigmoid<Type>(),indices,count,input,output);
+                }
+            }
+            break;
+        case ACTIVATION_FUNCTION_SIN:
+            if (signedActivation)
+            {
+                if (fast)
+                    applyKernel(FastSignedSin<Type>(),indices,count,input,output);
+                else
+                    applyKernel(SignedSin<Type>(),indices,count,input,output);
+            }
+            else
+            {
+                if (fast)
+                    applyKernel(FastUnsignedSin<Type>(),indices,count,input,output);
+                else
+                    applyKernel(UnsignedSin<Type>(),indices,count,input,output);
+            }
+            break;
+        case ACTIVATION_FUNCTION_COS:
+            if (signedActivation)
+            {
+                if (fast)
+                    applyKernel(FastSignedCos<Type>(),indices,count,input,output);
+                else
+                    applyKernel(SignedCos<Type>(),indices,count,input,output);
+            }
+            else
+            {
+                if (fast)
+                    applyKernel(FastUnsignedCos<Type>(),indices,count,input,output);
+                else
+                    applyKernel(UnsignedCos<Type>(),indices,count,input,output);
+            }
+            break;
+        case ACTIVATION_FUNCTION_GAUSSIAN:
+            if (fast)
+                applyKernel(FastGaussian<Type>(),indices,count,input,output);
+            else
+                applyKernel(Gaussian<Type>(),indices,count,input,output);
+            break;
+        case ACTIVATION_FUNCTION_SQUARE:
+            applyKernel(Square<Type>(),indices,count,input,output);
+            break;
+        case ACTIVATION_FUNCTION_ABS_ROOT:
+            if (signedActivation)
+                applyKernel(SignedAbsRoot<Type>(),indices,count,input,output);
+            else
+                applyKernel(UnsignedAbsRoot<Type>(),indices,count,input,output);
+            break;
+        case ACTIVATION_FUNCTION_LINEAR:
+            if (signedActivation)
+                applyKernel(SignedLinear<Type>(),indices,count,input,output);
+            else
+                applyKernel(UnsignedLinear<Type>(),indices,count,input,output);
+            break;
+        case ACTIVATION_FUNCTION_ONES_COMPLIMENT:
+            if (signedActivation)
+                applyKernel(SignedOnesCompliment<Type>(),indices,count,input,output);
+            else
+                applyKernel(UnsignedOnesCompliment<Type>(),indices,count,input,output);
+            break;
+        default:
+            throw CREATE_LOCATEDEXCEPTION_INFO("Unknown activation function!!!");
+            break;
+        }
+    }
+
+    template NEAT_DLL_EXPORT void runActivationKernel<float>(
+        ActivationFunction,const int *,int,const float *,float *,bool,bool,ActivationAccuracy
+        ); // explicit instantiation
+    template NEAT_DLL_EXPORT void runActivationKernel<double>(
+        ActivationFunction,const int *,int,const double *,double *,bool,bool,ActivationAccuracy
+        ); // explicit instantiation
+}
@@ -116,6 +116,9 @@ namespace NEAT
 			{
 				nodeBiases[a] = _nodeBiases[a];
 			}
+
+			incomingLinks.build(links,numLinks,numNodes,numConstantNodes);
+			linkWeightsChanged=false;
 	}
 
 	template<class Type>
@@ -213,6 +216,9 @@ namespace NEAT
 			}
 
 			memcpy(nodeBiases,_nodeBiases,sizeof(Type)*numNodes);
+
+			incomingLinks.build(links,numLinks,numNodes,numConstantNodes);
+			linkWeightsChanged=false;
 	}
 
 	/*
@@ -309,7 +315,8 @@ namespace NEAT
 	Network<Type>(),
 		numNodes(0),
 		numLinks(0),
-		data(NULL)
+		data(NULL),
+		linkWeightsChanged(false)
 	{}
 
 	template<class Type>
@@ -345,6 +352,8 @@ namespace NEAT
 			numLinks = other.numLinks;
 			nodeNameToIndex = other.nodeNameToIndex;
 			numConstantNodes = other.numConstantNodes;
+			incomingLinks = other.incomingLinks;
+			linkWeightsChanged = other.linkWeightsChanged;
 
 			data = (char*)realloc(
 				data,
@@ -488,6 +497,7 @@ namespace NEAT
 				links[a].toNode == toNodeIndex
 				)
 			{
+				linkWeightsChanged=true;
 				return &links[a];
 			}
 		}
@@ -518,27 +528,26 @@ namespace NEAT
 			this->activated=true;
 		}
 
+		if (linkWeightsChanged)
+		{
+			incomingLinks.refreshWeights(links);
+			linkWeightsChanged=false;
+		}
+
 		for (int a=0;a<count;a++)
 		{
 			/*for (int a=0;a<nodes.size();a++)
 			{
 			nodes[a]->computeNewValue();
 			}*/
-			memcpy(nodeNewValues,nodeBiases,sizeof(Type)*numNodes);
-
 #if DEBUG_NETWORK
 			cout << "NumLinks: " << numLinks << endl;
 #endif
-			for (int a=0;a<numLinks;a++)
+			for (int a=numConstantNodes;a<numNodes;a++)
 			{
+				nodeNewValues[a] = incomingLinks.sum(a,nodeValues,nodeBiases[a]);
 #if DEBUG_NETWORK
-				cout << links[a].fromNode << "->" << links[a].toNode << " : " << links[a].weight << endl;
-				cout << "Old value: " << nodeValues[links[a].fromNode] << endl;
-				cout << "Node value changed from " << nodeNewValues[links[a].toNode];
-#endif
-				nodeNewValues[links[a].toNode] += nodeValues[links[a].fromNode]*links[a].weight;
-#if DEBUG_NETWORK
-				cout << " to " << nodeNewValues[links[a].toNode] << endl;
+				cout << "Node " << a << " summed to " << nodeNewValues[a] << endl;
 #endif
 			}
 			//cout << "Done computing values.  Updating...\n";
@@ -22,11 +22,110 @@ namespace NEAT
     extern double signedSigmoidTable[6001];
     extern double unsignedSigmoidTable[6001];
 
+    template<class Type>
+    FastLayeredNetworkWeights<Type>::FastLayeredNetworkWeights()
+        :
+        transposedWeightsBuilt(false)
+    {
+    }
+
+    template<class Type>
+    FastLayeredNetworkWeights<Type>::FastLayeredNetworkWeights(const FastLayeredNetworkWeights<Type> &other)
+        :
+        layerWeights(other.layerWeights),
+        sparseWeights(other.sparseWeights),
+        weightsAreSparse(other.weightsAreSparse),
+        transposedWeightsBuilt(false)
+    {
+        //The transposed weights are rebuilt when needed, since the copy is
+        //made to be changed
+    }
+
+    template<class Type>
+    const vector< vector< PaddedMatrix<Type> > > &FastLayeredNetworkWeights<Type>::getTransposedWeights(
+        const vector<NetworkLayer<Type> > &layers
+        ) const
+    {
+        boost::mutex::scoped_lock scoped_lock(transposedWeightsMutex);
+
+        if(transposedWeightsBuilt)
+        {
+            return transposedWeights;
+        }
+
+        transposedWeights.assign(layers.size(),vector< PaddedMatrix<Type> >());
+
+        for(size_t toLayer=0;toLayer<layers.size();toLayer++)
+        {
+            const NetworkLayer<Type> &layer = layers[toLayer];
+
+            bool accumulated = !layer.fromLayers.empty();
+            for(size_t a=0;a<layer.fromLayers.size();a++)
+            {
+                if(!layers[layer.fromLayers[a]].fromLayers.empty())
+                {
+                    accumulated = false;
+                }
+            }
+
+            if(!accumulated)
+            {
+                continue;
+            }
+
+            for(size_t a=0;a<layer.fromLayers.size();a++)
+            {
+                int numToNodes = (int)layer.nodeValues.size();
+                int numFromNodes = (int)layers[layer.fromLayers[a]].nodeValues.size();
+
+                transposedWeights[toLayer].push_back(PaddedMatrix<Type>(numFromNodes,numToNodes));
+                PaddedMatrix<Type> &transposed = transposedWeights[toLayer].back();
+
+                if(weightsAreSparse[toLayer][a])
+                {
+                    const SparseMatrix<Type> &weights = sparseWeights[toLayer][a];
+                    for(int toNode=0;toNode<numToNodes;toNode++)
+                    {
+                        for(int b=weights.rowStarts[toNode];b<weights.rowStarts[toNode+1];b++)
+                        {
+                            transposed(weights.columns[b],toNode) = weights.values[b];
+                        }
+                    }
+                }
+                else
+                {
+                    const PaddedMatrix<Type> &weights = layerWeights[toLayer][a];
+                    for(int toNode=0;toNode<numToNodes;toNode++)
+                    {
+                        for(int fromNode=0;fromNode<numFromNodes;fromNode++)
+                        {
+                            transposed(fromNode,toNode) = weights(toNode,fromNode);
+                        }
+                    }
+                }
+            }
+        }
+
+        transposedWeightsBuilt = true;
+        return transposedWeights;
+    }
+
+    template<class Type>
+    void FastLayeredNetworkWeights<Type>::clearTransposedWeights()
+    {
+        boost::mutex::scoped_lock scoped_lock(transposedWeightsMutex);
+
+        vector< vector< PaddedMatrix<Type> > >().swap(transposedWeights);
+        transposedWeightsBuilt = false;
+    }
+
     template<class Type>
     FastLayeredNetwork<Type>::FastLayeredNetwork(const vector<NetworkLayer<Type> > &_layers)
         :
         Network<Type>(),
-        layers(_layers)
+        layers(_layers),
+        accumulatorWeights(NULL),
+        accumulatorValid(false)
     {
         //Perform a sanity check on the layers
         for(size_t toLayer=0;toLayer<layers.size();toLayer++)
@@ -41,10 +140,72 @@ namespace NEAT
                 }
             }
         }
+
+        double sparseLayerDensity = Globals::getSingleton()->getSparseLayerDensity();
+
+        //Move the weights into the padded layout, or the sparse one when
+        //most of them are zero
+        shared_ptr<FastLayeredNetworkWeights<Type> > newWeights(new FastLayeredNetworkWeights<Type>());
+        vector< vector< PaddedMatrix<Type> > > &layerWeights = newWeights->layerWeights;
+        vector< vector< SparseMatrix<Type> > > &sparseWeights = newWeights->sparseWeights;
+        vector< vector<bool> > &weightsAreSparse = newWeights->weightsAreSparse;
+
+        layerWeights.resize(layers.size());
+        sparseWeights.resize(layers.size());
+        weightsAreSparse.resize(layers.size());
+        paddedValues.resize(layers.size());
+        for(size_t toLayer=0;toLayer<layers.size();toLayer++)
+        {
+            NetworkLayer<Type> &layer = layers[toLayer];
+            int numToNodes = (int)layer.nodeValues.size();
+
+            paddedValues[toLayer].assign(PaddedMatrix<Type>::getPaddedSize(numToNodes),Type(0));
+
+            for(int a=0;a<(int)layer.fromLayers.size();a++)
+            {
+                int numFromNodes = (int)layers[layer.fromLayers[a]].nodeValues.size();
+
+                layerWeights[toLayer].push_back(PaddedMatrix<Type>(numToNodes,numFromNodes));
+
+                if(a<(int)layer.fromWeights.size() && (int)layer.fromWeights[a].size()==numToNodes*numFromNodes)
+                {
+                    PaddedMatrix<Type> &weights = layerWeights[toLayer][a];
+                    for(int toNode=0;toNode<numToNodes;toNode++)
+                    {
+                        for(int fromNode=0;fromNode<numFromNodes;fromNode++)
+                        {
+                            weights(toNode,fromNode) = layer.fromWeights[a][toNode*numFromNodes+fromNode];
+                        }
+                    }
+                }
+
+                PaddedMatrix<Type> &weights = layerWeights[toLayer][a];
+                bool sparse = (weights.numRows && weights.numColumns && getWeightDensity(weights)<sparseLayerDensity);
+
+                weightsAreSparse[toLayer].push_back(sparse);
+                if(sparse)
+                {
+                    sparseWeights[toLayer].push_back(SparseMatrix<Type>(weights));
+                    weights = PaddedMatrix<Type>();
+                }
+                else
+                {
+                    sparseWeights[toLayer].push_back(SparseMatrix<Type>());
+                }
+            }
+
+            vector< vector<Type> >().swap(layer.fromWeights);
+        }
+
+        weights = newWeights;
     }
 
     template<class Type>
     FastLayeredNetwork<Type>::FastLayeredNetwork()
+        :
+        weights(new FastLayeredNetworkWeights<Type>()),
+        accumulatorWeights(NULL),
+        accumulatorValid(false)
     {
     }
 
@@ -64,7 +225,7 @@ namespace NEAT
         NetworkLayer<Type> &layer = layers[nodeIndex.z];
 
         int nodeArrayIndex = nodeIndex.y*layer.nodeStride + nodeIndex.x;
-        if(nodeArrayIndex>(int)layer.nodeValues.size())
+        if(nodeArrayIndex>=(int)layer.nodeValues.size())
         {
             return false;
         }
@@ -83,7 +244,7 @@ namespace NEAT
         NetworkLayer<Type> &layer = layers[nodeIndex.z];
 
         int nodeArrayIndex = nodeIndex.y*layer.nodeStride + nodeIndex.x;
-        if(nodeArrayIndex>(int)layer.nodeValues.size())
+        if(nodeArrayIndex>=(int)layer.nodeValues.size())
         {
             throw CREATE_LOCATEDEXCEPTION_INFO("OOPS");
         }
@@ -102,12 +263,17 @@ namespace NEAT
         NetworkLayer<Type> &layer = layers[nodeIndex.z];
 
         int nodeArrayIndex = nodeIndex.y*layer.nodeStride + nodeIndex.x;
-        if(nodeArrayIndex>(int)layer.nodeValues.size())
+        if(nodeArrayIndex>=(int)layer.nodeValues.size())
         {
             throw CREATE_LOCATEDEXCEPTION_INFO("OOPS");
         }
 
         layer.nodeValues[nodeArrayIndex] = newValue;
+
+        if(layer.fromLayers.empty())
+        {
+            accumulatorValid = false;
+        }
     }
 
     template<class Type>
@@ -132,12 +298,18 @@ namespace NEAT
 
             int fromNodeArrayIndex = fromNodeIndex.y*fromLayer.nodeStride + fromNodeIndex.x;
             int toNodeArrayIndex = toNodeIndex.y*toLayer.nodeStride + toNodeIndex.x;
-            if(fromNodeArrayIndex>(int)fromLayer.nodeValues.size() || toNodeArrayIndex>(int)toLayer.nodeValues.size())
+            if(fromNodeArrayIndex>=(int)fromLayer.nodeValues.size() || toNodeArrayIndex>=(int)toLayer.nodeValues.size())
             {
                 return 0;
             }
 
-            return toLayer.fromWeights[a][toNodeArrayIndex*toLayer.nodeValues.size()+fromNodeArrayIndex];
+            if(weights->weightsAreSparse[toNodeIndex.z][a])
+            {
+                const Type *weight = weights->sparseWeights[toNodeIndex.z][a].find(toNodeArrayIndex,fromNodeArrayIndex);
+                return weight ? *weight : Type(0);
+            }
+
+            return weights->layerWeights[toNodeIndex.z][a](toNodeArrayIndex,fromNodeArrayIndex);
         }
 
         return 0;
@@ -151,6 +323,13 @@ namespace NEAT
             throw CREATE_LOCATEDEXCEPTION_INFO("OOPS");
         }
 
+        FastLayeredNetworkWeights<Type> &mutableWeights = getMutableWeights();
+
+        //The transposed weights are rebuilt on the next refresh
+        mutableWeights.clearTransposedWeights();
+        accumulatorWeights = NULL;
+        accumulatorValid = false;
+
         NetworkLayer<Type> &toLayer = layers[toNodeIndex.z];
 
         for(int a=0;a<(int)toLayer.fromLayers.size();a++)
@@ -165,12 +344,29 @@ namespace NEAT
 
             int fromNodeArrayIndex = fromNodeIndex.y*fromLayer.nodeStride + fromNodeIndex.x;
             int toNodeArrayIndex = toNodeIndex.y*toLayer.nodeStride + toNodeIndex.x;
-            if(fromNodeArrayIndex>(int)fromLayer.nodeValues.size() || toNodeArrayIndex>(int)toLayer.nodeValues.size())
+            if(fromNodeArrayIndex>=(int)fromLayer.nodeValues.size() || toNodeArrayIndex>=(int)toLayer.nodeValues.size())
             {
                 throw CREATE_LOCATEDEXCEPTION_INFO("OOPS");
             }
 
-            toLayer.fromWeights[a][toNodeArrayIndex*toLayer.nodeValues.size()+fromNodeArrayIndex] = weight;
+            if(mutableWeights.weightsAreSparse[toNodeIndex.z][a])
+            {
+                Type *sparseWeight = mutableWeights.sparseWeights[toNodeIndex.z][a].find(toNodeArrayIndex,fromNodeArrayIndex);
+                if(sparseWeight)
+                {
+                    *sparseWeight = weight;
+                    return;
+                }
+                if(weight==Type(0))
+                {
+                    return;
+                }
+
+                //A new nonzero weight doesn't fit in the sparse layout
+                makeDense(toNodeIndex.z,a);
+            }
+
+            mutableWeights.layerWeights[toNodeIndex.z][a](toNodeArrayIndex,fromNodeArrayIndex) = weight;
             return;
         }
 
@@ -184,59 +380,435 @@ namespace NEAT
         {
             layers[a].initialize();
         }
+
+        accumulatorValid = false;
     }
 
     template<class Type>
     void FastLayeredNetwork<Type>::update()
     {
-        for(typename vector<NetworkLayer<Type> >::iterator layer = layers.begin();layer != layers.end();layer++)
+        ActivationAccuracy accuracy = Globals::getSingleton()->getActivationAccuracy();
+
+        for(size_t layerIndex=0;layerIndex<layers.size();layerIndex++)
         {
-            vector<Type> &toNodes = layer->nodeValues;
-            int numToNodes = (int)toNodes.size();
-            int toNode;
+            updateLayer(layerIndex,accuracy);
+        }
+    }
 
-            //If you don't come from any layers, it's assumed that you are an input
-            //layer and your node values are constant
-            if(layer->fromLayers.size())
+    template<class Type>
+    void FastLayeredNetwork<Type>::updateLayer(size_t layerIndex,ActivationAccuracy accuracy)
+    {
+        NetworkLayer<Type> &layer = layers[layerIndex];
+        vector<Type> &toNodes = layer.nodeValues;
+        int numToNodes = (int)toNodes.size();
+        Type *toValues = &paddedValues[layerIndex][0];
+
+        //If you don't come from any layers, it's assumed that you are an input
+        //layer and your node values are constant
+        if(layer.fromLayers.empty())
+        {
+            if(numToNodes)
             {
-                for(toNode=0;toNode<numToNodes;toNode++)
+                memcpy(toValues,&toNodes[0],sizeof(Type)*numToNodes);
+            }
+            return;
+        }
+
+        memset(toValues,0,sizeof(Type)*paddedValues[layerIndex].size());
+
+        //The activation is applied along with the last source layer.
+        //The signed sigmoid of the zero padding is zero, so the padding
+        //stays clean for the layers that read this one.
+        for(size_t a=0;a<layer.fromLayers.size();a++)
+        {
+            int fromLayer = layer.fromLayers[a];
+
+            multiplyWeights(
+                (int)layerIndex,
+                (int)a,
+                1,
+                &paddedValues[fromLayer][0],
+                (int)paddedValues[fromLayer].size(),
+                toValues,
+                (int)paddedValues[layerIndex].size(),
+                a+1==layer.fromLayers.size(),
+                accuracy
+                );
+        }
+
+        if(numToNodes)
+        {
+            memcpy(&toNodes[0],toValues,sizeof(Type)*numToNodes);
+        }
+    }
+
+    template<class Type>
+    void FastLayeredNetwork<Type>::setInputValue(const Node &nodeIndex,Type newValue)
+    {
+        if(nodeIndex.z>=(int)layers.size())
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("OOPS");
+        }
+
+        NetworkLayer<Type> &layer = layers[nodeIndex.z];
+
+        if(!layer.fromLayers.empty())
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("Only input layers can be set incrementally!");
+        }
+
+        int nodeArrayIndex = nodeIndex.y*layer.nodeStride + nodeIndex.x;
+        if(nodeArrayIndex>=(int)layer.nodeValues.size())
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("OOPS");
+        }
+
+        Type delta = newValue - layer.nodeValues[nodeArrayIndex];
+        layer.nodeValues[nodeArrayIndex] = newValue;
+
+        if(delta==Type(0) || !accumulatorValid)
+        {
+            return;
+        }
+
+        const vector< vector< PaddedMatrix<Type> > > &transposedWeights = *accumulatorWeights;
+
+        for(size_t toLayer=0;toLayer<transposedWeights.size();toLayer++)
+        {
+            for(size_t a=0;a<transposedWeights[toLayer].size();a++)
+            {
+                if(layers[toLayer].fromLayers[a] != nodeIndex.z)
                 {
-                    toNodes[toNode]=0.0f;
+                    continue;
                 }
 
-                for(size_t a=0;a<layer->fromLayers.size();a++)
+                const PaddedMatrix<Type> &transposed = transposedWeights[toLayer][a];
+                const Type *nodeWeights = &transposed(nodeArrayIndex,0);
+                Type *sums = &accumulatorValues[toLayer][0];
+
+                for(int toNode=0;toNode<transposed.numColumns;toNode++)
                 {
-                    const NetworkLayer<Type> &fromLayer = layers[layer->fromLayers[a]];
+                    sums[toNode] += delta*nodeWeights[toNode];
+                }
+            }
+        }
+    }
 
-                    const vector<Type> &fromNodes = fromLayer.nodeValues;
-                    const Type* fromNodesPtr = &(fromLayer.nodeValues[0]);
-                    int numFromNodes = (int)fromNodes.size();
+    template<class Type>
+    void FastLayeredNetwork<Type>::refreshAccumulator()
+    {
+        accumulatorWeights = &weights->getTransposedWeights(layers);
+        accumulatorValues.resize(layers.size());
 
-                    Type nodeValue;
-                    int fromNode;
-                    Type* weightsPtr;
-                    for(toNode=0;toNode<numToNodes;toNode++)
-                    {
-                        nodeValue=0;
-                        weightsPtr = &(layer->fromWeights[a][toNode*layer->nodeValues.size()]);
-                        for(fromNode=0;fromNode<numFromNodes;fromNode++)
-                        {
-                            nodeValue += fromNodesPtr[fromNode] * weightsPtr[fromNode];
-                        }
+        ActivationAccuracy accuracy = Globals::getSingleton()->getActivationAccuracy();
 
-                        toNodes[toNode] += nodeValue;
-                    }
-                }
+        for(size_t layerIndex=0;layerIndex<layers.size();layerIndex++)
+        {
+            if(layers[layerIndex].fromLayers.empty())
+            {
+                updateLayer(layerIndex,accuracy);
+            }
+        }
+
+        for(size_t layerIndex=0;layerIndex<layers.size();layerIndex++)
+        {
+            if((*accumulatorWeights)[layerIndex].empty())
+            {
+                continue;
+            }
+
+            NetworkLayer<Type> &layer = layers[layerIndex];
+            typename PaddedMatrix<Type>::AlignedVector &sums = accumulatorValues[layerIndex];
+
+            sums.assign(paddedValues[layerIndex].size(),Type(0));
+
+            for(size_t a=0;a<layer.fromLayers.size();a++)
+            {
+                int fromLayer = layer.fromLayers[a];
+
+                multiplyWeights(
+                    (int)layerIndex,
+                    (int)a,
+                    1,
+                    &paddedValues[fromLayer][0],
+                    (int)paddedValues[fromLayer].size(),
+                    &sums[0],
+                    (int)sums.size(),
+                    false,
+                    accuracy
+                    );
+            }
+        }
+
+        accumulatorValid = true;
+    }
 
-                for(toNode=0;toNode<numToNodes;toNode++)
+    template<class Type>
+    void FastLayeredNetwork<Type>::updateFromAccumulator()
+    {
+        if(!accumulatorValid)
+        {
+            refreshAccumulator();
+        }
+
+        ActivationAccuracy accuracy = Globals::getSingleton()->getActivationAccuracy();
+
+        for(size_t layerIndex=0;layerIndex<layers.size();layerIndex++)
+        {
+            if((*accumulatorWeights)[layerIndex].empty())
+            {
+                updateLayer(layerIndex,accuracy);
+                continue;
+            }
+
+            vector<Type> &toNodes = layers[layerIndex].nodeValues;
+            typename PaddedMatrix<Type>::AlignedVector &toValues = paddedValues[layerIndex];
+
+            memcpy(&toValues[0],&accumulatorValues[layerIndex][0],sizeof(Type)*toValues.size());
+            activateLayer(&toValues[0],(int)toValues.size(),accuracy);
+
+            if(!toNodes.empty())
+            {
+                memcpy(&toNodes[0],&toValues[0],sizeof(Type)*toNodes.size());
+            }
+        }
+    }
+
+    template<class Type>
+    void FastLayeredNetwork<Type>::updateBatch(
+        int numSamples,
+        const Type *inputValues,
+        Type *outputValues
+        )
+    {
+        if(numSamples<=0 || layers.empty())
+        {
+            return;
+        }
+
+        ActivationAccuracy accuracy = Globals::getSingleton()->getActivationAccuracy();
+        int numInputValues = getNumInputValues();
+
+        batchValues.resize(layers.size());
+
+        int inputOffset=0;
+        for(size_t layerIndex=0;layerIndex<layers.size();layerIndex++)
+        {
+            NetworkLayer<Type> &layer = layers[layerIndex];
+            int numToNodes = (int)layer.nodeValues.size();
+            int valueStride = (int)paddedValues[layerIndex].size();
+            typename PaddedMatrix<Type>::AlignedVector &toValues = batchValues[layerIndex];
+
+            if(toValues.size()<size_t(numSamples)*valueStride)
+            {
+                toValues.resize(size_t(numSamples)*valueStride);
+            }
+            memset(&toValues[0],0,sizeof(Type)*size_t(numSamples)*valueStride);
+
+            if(layer.fromLayers.empty())
+            {
+                if(numToNodes)
                 {
-                    //Signed sigmoid activation function
-                    toNodes[toNode] = (2.0f / (1.0f + exp(-toNodes[toNode]))) - 1.0f;
+                    for(int sample=0;sample<numSamples;sample++)
+                    {
+                        memcpy(
+                            &toValues[size_t(sample)*valueStride],
+                            inputValues+size_t(sample)*numInputValues+inputOffset,
+                            sizeof(Type)*numToNodes
+                            );
+                    }
                 }
+                inputOffset += numToNodes;
+                continue;
+            }
+
+            for(size_t a=0;a<layer.fromLayers.size();a++)
+            {
+                int fromLayer = layer.fromLayers[a];
+
+                multiplyWeights(
+                    (int)layerIndex,
+                    (int)a,
+                    numSamples,
+                    &batchValues[fromLayer][0],
+                    (int)paddedValues[fromLayer].size(),
+                    &toValues[0],
+                    valueStride,
+                    a+1==layer.fromLayers.size(),
+                    accuracy
+                    );
+            }
+        }
+
+        int lastLayer = int(layers.size())-1;
+        int numOutputValues = getNumOutputValues();
+        int outputStride = (int)paddedValues[lastLayer].size();
+        if(numOutputValues)
+        {
+            for(int sample=0;sample<numSamples;sample++)
+            {
+                memcpy(
+                    outputValues+size_t(sample)*numOutputValues,
+                    &batchValues[lastLayer][size_t(sample)*outputStride],
+                    sizeof(Type)*numOutputValues
+                    );
             }
         }
     }
 
+    template<class Type>
+    int FastLayeredNetwork<Type>::getNumInputValues()
+    {
+        int numInputValues=0;
+        for(size_t a=0;a<layers.size();a++)
+        {
+            if(layers[a].fromLayers.empty())
+            {
+                numInputValues += (int)layers[a].nodeValues.size();
+            }
+        }
+        return numInputValues;
+    }
+
+    template<class Type>
+    int FastLayeredNetwork<Type>::getNumOutputValues()
+    {
+        if(layers.empty())
+        {
+            return 0;
+        }
+        return (int)layers.back().nodeValues.size();
+    }
+
+    template<class Type>
+    LayerView<Type> FastLayeredNetwork<Type>::getInputLayerValues(int layerIndex)
+    {
+        if(layerIndex<0 || layerIndex>=(int)layers.size())
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("OOPS");
+        }
+
+        NetworkLayer<Type> &layer = layers[layerIndex];
+
+        if(!layer.fromLayers.empty())
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("Only input layers can be written directly!");
+        }
+
+        //The writes can't be tracked
+        accumulatorValid = false;
+
+        int numNodes = (int)layer.nodeValues.size();
+        if(!numNodes)
+        {
+            return LayerView<Type>();
+        }
+
+        return LayerView<Type>(&layer.nodeValues[0],layer.nodeStride,numNodes/layer.nodeStride,layer.nodeStride);
+    }
+
+    template<class Type>
+    LayerView<const Type> FastLayeredNetwork<Type>::getLayerValues(int layerIndex) const
+    {
+        if(layerIndex<0 || layerIndex>=(int)layers.size())
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("OOPS");
+        }
+
+        const NetworkLayer<Type> &layer = layers[layerIndex];
+
+        int numNodes = (int)layer.nodeValues.size();
+        if(!numNodes)
+        {
+            return LayerView<const Type>();
+        }
+
+        return LayerView<const Type>(&layer.nodeValues[0],layer.nodeStride,numNodes/layer.nodeStride,layer.nodeStride);
+    }
+
+    template<class Type>
+    int FastLayeredNetwork<Type>::getNumSparseLayerPairs()
+    {
+        int numSparse=0;
+        for(size_t layerIndex=0;layerIndex<weights->weightsAreSparse.size();layerIndex++)
+        {
+            const vector<bool> &layerIsSparse = weights->weightsAreSparse[layerIndex];
+            numSparse += (int)count(layerIsSparse.begin(),layerIsSparse.end(),true);
+        }
+        return numSparse;
+    }
+
+    template<class Type>
+    void FastLayeredNetwork<Type>::multiplyWeights(
+        int layerIndex,
+        int a,
+        int numSamples,
+        const Type *inputs,
+        int inputStride,
+        Type *outputs,
+        int outputStride,
+        bool activate,
+        ActivationAccuracy accuracy
+        )
+    {
+        if(weights->weightsAreSparse[layerIndex][a])
+        {
+            multiplySparseLayerBatch(
+                weights->sparseWeights[layerIndex][a],
+                numSamples,
+                inputs,
+                inputStride,
+                outputs,
+                outputStride,
+                activate,
+                accuracy
+                );
+        }
+        else
+        {
+            multiplyLayerBatch(
+                weights->layerWeights[layerIndex][a],
+                numSamples,
+                inputs,
+                inputStride,
+                outputs,
+                outputStride,
+                activate,
+                accuracy
+                );
+        }
+    }
+
+    template<class Type>
+    void FastLayeredNetwork<Type>::makeDense(int layerIndex,int a)
+    {
+        FastLayeredNetworkWeights<Type> &mutableWeights = getMutableWeights();
+        SparseMatrix<Type> &sparse = mutableWeights.sparseWeights[layerIndex][a];
+
+        mutableWeights.layerWeights[layerIndex][a] = PaddedMatrix<Type>(sparse.numRows,sparse.numColumns);
+        sparse.expand(mutableWeights.layerWeights[layerIndex][a]);
+
+        sparse = SparseMatrix<Type>();
+        mutableWeights.weightsAreSparse[layerIndex][a] = false;
+    }
+
+    template<class Type>
+    FastLayeredNetworkWeights<Type> &FastLayeredNetwork<Type>::getMutableWeights()
+    {
+        if(!weights.unique())
+        {
+            weights.reset(new FastLayeredNetworkWeights<Type>(*weights));
+            accumulatorWeights = NULL;
+            accumulatorValid = false;
+        }
+
+        //Nobody else sees these weights, so they can be changed
+        return const_cast<FastLayeredNetworkWeights<Type> &>(*weights);
+    }
+
+    template class FastLayeredNetworkWeights<float>; // explicit instantiation
+    template class FastLayeredNetworkWeights<double>; // explicit instantiation
+
     template class FastLayeredNetwork<float>; // explicit instantiation
     template class FastLayeredNetwork<double>; // explicit instantiation
 }
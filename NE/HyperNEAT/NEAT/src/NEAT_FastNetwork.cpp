@@ -22,33 +22,40 @@ namespace NEAT
     extern double signedSigmoidTable[6001];
     extern double unsignedSigmoidTable[6001];
 
+    /**
+     * Orders node indices by name, and by index among equal names
+     */
+    class NodeNameLess
+    {
+        const string *names;
+
+    public:
+        NodeNameLess(const string *_names)
+            :
+        names(_names)
+        {}
+
+        inline bool operator()(int a,int b) const
+        {
+            int comparison = names[a].compare(names[b]);
+            return comparison<0 || (comparison==0 && a<b);
+        }
+    };
+
     template<class Type>
     FastNetwork<Type>::FastNetwork(const vector<NetworkNode *> &_nodes,const vector<NetworkLink *> &_links)
         :
     Network<Type>(),
         numNodes(int(_nodes.size())),
-        numLinks(int(_links.size()))
+        numLinks(int(_links.size())),
+        nodeNames(_nodes.size()),
+        data(NULL),
+        dataCapacity(0),
+        nodeLinkMapBuilt(false)
     {
-        data = (char*)malloc(
-            sizeof(Type)*2*numNodes +
-            sizeof(ActivationFunction)*numNodes +
-            sizeof(NetworkIndexedLink<Type>)*numLinks
-            );
-
-        memset(
-            data,
-            0,
-            sizeof(Type)*2*numNodes +
-            sizeof(ActivationFunction)*numNodes +
-            sizeof(NetworkIndexedLink<Type>)*numLinks
-            );
+        reserveData();
 
-        nodeValues = (Type*)&data[0];
-        nodeNewValues = (Type*)&data[sizeof(Type)*numNodes];
-        activationFunctions = (ActivationFunction*)&data[sizeof(Type)*2*numNodes];
-        links = (NetworkIndexedLink<Type>*)&data[
-            sizeof(Type)*2*numNodes +
-                sizeof(ActivationFunction)*numNodes];
+        memset(data,0,dataCapacity);
 
             numConstantNodes = 0;
 
@@ -64,7 +71,7 @@ namespace NEAT
 #endif
                 if (!_nodes[a]->getUpdate())
                 {
-                    nodeNameToIndex[_nodes[a]->getName()] = numConstantNodes;
+                    nodeNames[numConstantNodes] = _nodes[a]->getName();
                     activationFunctions[numConstantNodes] = _nodes[a]->getActivationFunction();
                     nodePointerToIndex[_nodes[a]] = numConstantNodes;
                     numConstantNodes++;
@@ -83,7 +90,7 @@ namespace NEAT
 #endif
                 if (_nodes[a]->getUpdate())
                 {
-                    nodeNameToIndex[_nodes[a]->getName()] = currentNode;
+                    nodeNames[currentNode] = _nodes[a]->getName();
                     activationFunctions[currentNode] = _nodes[a]->getActivationFunction();
                     nodePointerToIndex[_nodes[a]] = currentNode;
                     currentNode++;
@@ -101,9 +108,9 @@ namespace NEAT
                 links[a].fromNode = nodePointerToIndex[_links[a]->getFromNode()];
                 links[a].toNode = nodePointerToIndex[_links[a]->getToNode()];
                 links[a].weight = (Type)_links[a]->getWeight();
-
-                nodeLinkMap[pair<int,int>(links[a].fromNode,links[a].toNode)] = a;
             }
+
+            buildIndexes();
     }
 
     template<class Type>
@@ -111,28 +118,15 @@ namespace NEAT
         :
     Network<Type>(),
         numNodes(_numNodes),
-        numLinks(_numLinks)
+        numLinks(_numLinks),
+        nodeNames(_numNodes),
+        data(NULL),
+        dataCapacity(0),
+        nodeLinkMapBuilt(false)
     {
-        data = (char*)malloc(
-            sizeof(Type)*2*numNodes +
-            sizeof(ActivationFunction)*numNodes +
-            sizeof(NetworkIndexedLink<Type>)*numLinks
-            );
-
-        memset(
-            data,
-            0,
-            sizeof(Type)*2*numNodes +
-            sizeof(ActivationFunction)*numNodes +
-            sizeof(NetworkIndexedLink<Type>)*numLinks
-            );
+        reserveData();
 
-        nodeValues = (Type*)&data[0];
-        nodeNewValues = (Type*)&data[sizeof(Type)*numNodes];
-        activationFunctions = (ActivationFunction*)&data[sizeof(Type)*2*numNodes];
-        links = (NetworkIndexedLink<Type>*)&data[
-            sizeof(Type)*2*numNodes +
-                sizeof(ActivationFunction)*numNodes];
+        memset(data,0,dataCapacity);
 
             numConstantNodes = 0;
 
@@ -148,7 +142,7 @@ namespace NEAT
 #endif
                 if (!_nodes[a].getUpdate())
                 {
-                    nodeNameToIndex[_nodes[a].getName()] = numConstantNodes;
+                    nodeNames[numConstantNodes] = _nodes[a].getName();
                     activationFunctions[numConstantNodes] = _nodes[a].getActivationFunction();
                     nodePointerToIndex[&_nodes[a]] = numConstantNodes;
                     numConstantNodes++;
@@ -167,7 +161,7 @@ namespace NEAT
 #endif
                 if (_nodes[a].getUpdate())
                 {
-                    nodeNameToIndex[_nodes[a].getName()] = currentNode;
+                    nodeNames[currentNode] = _nodes[a].getName();
                     activationFunctions[currentNode] = _nodes[a].getActivationFunction();
                     nodePointerToIndex[&_nodes[a]] = currentNode;
                     currentNode++;
@@ -185,9 +179,9 @@ namespace NEAT
                 links[a].fromNode = nodePointerToIndex[_links[a].getFromNode()];
                 links[a].toNode = nodePointerToIndex[_links[a].getToNode()];
                 links[a].weight = (Type)_links[a].getWeight();
-
-                nodeLinkMap[pair<int,int>(links[a].fromNode,links[a].toNode)] = a;
             }
+
+            buildIndexes();
     }
 
     template<class Type>
@@ -197,34 +191,40 @@ namespace NEAT
         )
         :
     Network<Type>(),
-        numNodes(int(_nodes.size())),
-        numLinks(int(_links.size()))
+        numNodes(0),
+        numLinks(0),
+        data(NULL),
+        dataCapacity(0),
+        nodeLinkMapBuilt(false)
     {
-        data = (char*)malloc(
-            sizeof(Type)*2*numNodes +
-            sizeof(ActivationFunction)*numNodes +
-            sizeof(NetworkIndexedLink<Type>)*numLinks
-            );
+        rebind(_nodes,_links);
+    }
 
-        memset(
-            data,
-            0,
-            sizeof(Type)*2*numNodes +
-            sizeof(ActivationFunction)*numNodes +
-            sizeof(NetworkIndexedLink<Type>)*numLinks
-            );
+    template<class Type>
+    void FastNetwork<Type>::rebind(
+        const vector<GeneticNodeGene> &_nodes,
+        const vector<GeneticLinkGene> &_links
+        )
+    {
+        this->activated = false;
 
-        nodeValues = (Type*)&data[0];
-        nodeNewValues = (Type*)&data[sizeof(Type)*numNodes];
-        activationFunctions = (ActivationFunction*)&data[sizeof(Type)*2*numNodes];
-        links = (NetworkIndexedLink<Type>*)&data[
-            sizeof(Type)*2*numNodes +
-                sizeof(ActivationFunction)*numNodes];
+        numNodes = int(_nodes.size());
+        numLinks = int(_links.size());
+
+        reserveData();
+
+        memset(data,0,dataCapacity);
+
+        if ((int)nodeNames.size()<numNodes)
+        {
+            nodeNames.resize(numNodes);
+        }
 
             numConstantNodes = 0;
 
-            map<const GeneticNodeGene*,int> nodePointerToIndex;
-            map<int,int> nodeIDToIndex;
+            //Sorted (ID,index) pairs stand in for a map from node ID to index
+            vector<pair<int,int> > &nodeIDToIndex = buildScratch.nodeIDToIndex;
+            nodeIDToIndex.clear();
 
 #if DEBUG_NETWORK_CREATION
             cout << "Pass #1\n";
@@ -234,12 +234,11 @@ namespace NEAT
 #if DEBUG_NETWORK_CREATION
                 cout << "On Node " << a << endl;
 #endif
-                if (_nodes[a].getType()==string("NetworkSensor"))
+                if (_nodes[a].getType()=="NetworkSensor")
                 {
-                    nodeNameToIndex[_nodes[a].getName()] = numConstantNodes;
+                    nodeNames[numConstantNodes] = _nodes[a].getName();
                     activationFunctions[numConstantNodes] = _nodes[a].getActivationFunction();
-                    nodePointerToIndex[&_nodes[a]] = numConstantNodes;
-                    nodeIDToIndex[_nodes[a].getID()] = numConstantNodes;
+                    nodeIDToIndex.push_back(pair<int,int>(_nodes[a].getID(),numConstantNodes));
                     numConstantNodes++;
                 }
             }
@@ -254,16 +253,17 @@ namespace NEAT
 #if DEBUG_NETWORK_CREATION
                 cout << "On Node " << a << endl;
 #endif
-                if (_nodes[a].getType()!=string("NetworkSensor"))
+                if (_nodes[a].getType()!="NetworkSensor")
                 {
-                    nodeNameToIndex[_nodes[a].getName()] = currentNode;
+                    nodeNames[currentNode] = _nodes[a].getName();
                     activationFunctions[currentNode] = _nodes[a].getActivationFunction();
-                    nodePointerToIndex[&_nodes[a]] = currentNode;
-                    nodeIDToIndex[_nodes[a].getID()] = currentNode;
+                    nodeIDToIndex.push_back(pair<int,int>(_nodes[a].getID(),currentNode));
                     currentNode++;
                 }
             }
 
+            sort(nodeIDToIndex.begin(),nodeIDToIndex.end());
+
 #if DEBUG_NETWORK_CREATION
             cout << "Link Pass\n";
 #endif
@@ -272,13 +272,29 @@ namespace NEAT
 #if DEBUG_NETWORK_CREATION
                 cout << "On Link " << a << endl;
 #endif
-                links[a].fromNode = nodeIDToIndex[_links[a].getFromNodeID()];
-                links[a].toNode = nodeIDToIndex[_links[a].getToNodeID()];
-                links[a].weight = (Type)_links[a].getWeight();
+                int nodeIDs[2] = { _links[a].getFromNodeID(), _links[a].getToNodeID() };
+                int nodeIndices[2];
+                for (int b=0;b<2;b++)
+                {
+                    //If two nodes share an ID, the later one wins like it did in a map
+                    vector<pair<int,int> >::iterator it = upper_bound(
+                        nodeIDToIndex.begin(),
+                        nodeIDToIndex.end(),
+                        pair<int,int>(nodeIDs[b],INT_MAX)
+                        );
+                    if (it==nodeIDToIndex.begin() || (--it)->first!=nodeIDs[b])
+                    {
+                        throw CREATE_LOCATEDEXCEPTION_INFO("ERROR: A link refers to a node that is not in the genome!");
+                    }
+                    nodeIndices[b] = it->second;
+                }
 
-                nodeLinkMap[pair<int,int>(links[a].fromNode,links[a].toNode)] = a;
+                links[a].fromNode = nodeIndices[0];
+                links[a].toNode = nodeIndices[1];
+                links[a].weight = (Type)_links[a].getWeight();
             }
 
+            buildIndexes();
     }
 
     template<class Type>
@@ -287,7 +303,14 @@ namespace NEAT
     Network<Type>(),
         numNodes(0),
         numLinks(0),
-        data(NULL)
+        data(NULL),
+        dataCapacity(0),
+        nodeLinkMapBuilt(false),
+        numConstantNodes(0),
+        linkWeightsChanged(false),
+        feedForward(false),
+        feedForwardDepth(0),
+        compiled()
     {
 	}
 
@@ -305,7 +328,9 @@ namespace NEAT
     template<class Type>
     FastNetwork<Type>::FastNetwork(const FastNetwork<Type> &other)
         :
-    data(NULL)
+    data(NULL),
+        dataCapacity(0),
+        nodeLinkMapBuilt(false)
     {
 #if DEBUG_NETWORK_CREATION
         cout << "Network copy called!\n";
@@ -322,23 +347,30 @@ namespace NEAT
 
             numNodes = other.numNodes;
             numLinks = other.numLinks;
-            nodeNameToIndex = other.nodeNameToIndex;
+            nodeNames.assign(other.nodeNames.begin(),other.nodeNames.begin()+numNodes);
+            nodeNameOrder = other.nodeNameOrder;
             numConstantNodes = other.numConstantNodes;
-            nodeLinkMap = other.nodeLinkMap;
-
-            data = (char*)realloc(
-                data,
-                sizeof(Type)*2*numNodes +
-                sizeof(ActivationFunction)*numNodes +
-                sizeof(NetworkIndexedLink<Type>)*numLinks
-                );
-
-            nodeValues = (Type*)&data[0];
-            nodeNewValues = (Type*)&data[sizeof(Type)*numNodes];
-            activationFunctions = (ActivationFunction*)&data[sizeof(Type)*2*numNodes];
-            links = (NetworkIndexedLink<Type>*)&data[
-                sizeof(Type)*2*numNodes +
-                    sizeof(ActivationFunction)*numNodes];
+            if (other.nodeLinkMapBuilt)
+            {
+                nodeLinkMap = other.nodeLinkMap;
+            }
+            else
+            {
+                nodeLinkMap.clear();
+            }
+            nodeLinkMapBuilt = other.nodeLinkMapBuilt;
+            feedForward = other.feedForward;
+            feedForwardDepth = other.feedForwardDepth;
+            feedForwardNodes = other.feedForwardNodes;
+            feedForwardGroups = other.feedForwardGroups;
+            activationNodes = other.activationNodes;
+            activationGroups = other.activationGroups;
+            incomingLinks = other.incomingLinks;
+            linkWeightsChanged = other.linkWeightsChanged;
+            compiled = other.compiled;
+            backPropScratch.built=false;
+
+            reserveData();
 
                 if (other.data)
                 {
@@ -364,6 +396,217 @@ namespace NEAT
             free(data);
     }
 
+    template<class Type>
+    void FastNetwork<Type>::reserveData()
+    {
+        size_t dataSize =
+            sizeof(Type)*2*numNodes +
+            sizeof(ActivationFunction)*numNodes +
+            sizeof(NetworkIndexedLink<Type>)*numLinks;
+
+        //Only ever grows, so rebinding to a smaller genome doesn't allocate
+        if (dataSize>dataCapacity || !data)
+        {
+            data = (char*)realloc(data,max(dataSize,size_t(1)));
+            dataCapacity = max(dataSize,size_t(1));
+        }
+
+        nodeValues = (Type*)&data[0];
+        nodeNewValues = (Type*)&data[sizeof(Type)*numNodes];
+        activationFunctions = (ActivationFunction*)&data[sizeof(Type)*2*numNodes];
+        links = (NetworkIndexedLink<Type>*)&data[
+            sizeof(Type)*2*numNodes +
+                sizeof(ActivationFunction)*numNodes];
+    }
+
+    template<class Type>
+    void FastNetwork<Type>::buildIndexes()
+    {
+        nodeNameOrder.resize(numNodes);
+        for (int a=0;a<numNodes;a++)
+        {
+            nodeNameOrder[a] = a;
+        }
+        if (numNodes)
+        {
+            sort(nodeNameOrder.begin(),nodeNameOrder.end(),NodeNameLess(&nodeNames[0]));
+        }
+
+        nodeLinkMap.clear();
+        nodeLinkMapBuilt=false;
+
+        incomingLinks.build(links,numLinks,numNodes,numConstantNodes);
+        linkWeightsChanged=false;
+        compiled.reset();
+
+        backPropScratch.built=false;
+
+        computeActivationGroups();
+        computeFeedForwardPlan();
+    }
+
+    template<class Type>
+    void FastNetwork<Type>::buildNodeLinkMap()
+    {
+        if (nodeLinkMapBuilt)
+        {
+            return;
+        }
+
+        nodeLinkMap.clear();
+        for (int a=0;a<numLinks;a++)
+        {
+            nodeLinkMap[pair<int,int>(links[a].fromNode,links[a].toNode)] = a;
+        }
+        nodeLinkMapBuilt=true;
+    }
+
+    template<class Type>
+    void FastNetwork<Type>::refreshIncomingLinks()
+    {
+        if (linkWeightsChanged)
+        {
+            incomingLinks.refreshWeights(links);
+            linkWeightsChanged=false;
+
+            //The compiled code still has the old weights
+            compiled.reset();
+        }
+    }
+
+    template<class Type>
+    void FastNetwork<Type>::computeActivationGroups()
+    {
+        //Counting sort of the updated nodes by activation function
+        int groupStart[ACTIVATION_FUNCTION_END+1] = {0};
+        for (int a=numConstantNodes;a<numNodes;a++)
+        {
+            groupStart[activationFunctions[a]+1]++;
+        }
+        for (int a=0;a<ACTIVATION_FUNCTION_END;a++)
+        {
+            groupStart[a+1] += groupStart[a];
+        }
+
+        activationNodes.resize(numNodes-numConstantNodes);
+        int groupFill[ACTIVATION_FUNCTION_END];
+        copy(groupStart,groupStart+ACTIVATION_FUNCTION_END,groupFill);
+        for (int a=numConstantNodes;a<numNodes;a++)
+        {
+            activationNodes[groupFill[activationFunctions[a]]++] = a;
+        }
+
+        activationGroups.clear();
+        for (int a=0;a<ACTIVATION_FUNCTION_END;a++)
+        {
+            if (groupStart[a]<groupStart[a+1])
+            {
+                activationGroups.push_back(ActivationGroup(ActivationFunction(a),groupStart[a],groupStart[a+1]));
+            }
+        }
+    }
+
+    template<class Type>
+    void FastNetwork<Type>::computeFeedForwardPlan()
+    {
+        feedForward = false;
+        feedForwardDepth = 0;
+        feedForwardNodes.clear();
+        feedForwardGroups.clear();
+
+        //Build the outgoing adjacency between updated nodes.  Links into
+        //constant nodes are never applied, and links out of constant nodes
+        //can't create a cycle, so both are left out of the ordering.
+        vector<int> &inDegree = buildScratch.inDegree;
+        vector<int> &outStart = buildScratch.outStart;
+        inDegree.assign(numNodes,0);
+        outStart.assign(numNodes+1,0);
+        for (int a=0;a<numLinks;a++)
+        {
+            if (links[a].fromNode>=numConstantNodes && links[a].toNode>=numConstantNodes)
+            {
+                inDegree[links[a].toNode]++;
+                outStart[links[a].fromNode+1]++;
+            }
+        }
+        for (int a=0;a<numNodes;a++)
+        {
+            outStart[a+1] += outStart[a];
+        }
+        vector<int> &outLinks = buildScratch.outLinks;
+        vector<int> &outFill = buildScratch.outFill;
+        outLinks.resize(outStart[numNodes]);
+        outFill.assign(outStart.begin(),outStart.end()-1);
+        for (int a=0;a<numLinks;a++)
+        {
+            if (links[a].fromNode>=numConstantNodes && links[a].toNode>=numConstantNodes)
+            {
+                outLinks[outFill[links[a].fromNode]++] = a;
+            }
+        }
+
+        //Kahn's algorithm, using feedForwardNodes as the queue.  The depth of a
+        //node is the number of synchronous updates it needs to settle.
+        vector<int> &depth = buildScratch.depth;
+        depth.assign(numNodes,0);
+        feedForwardNodes.reserve(numNodes-numConstantNodes);
+        for (int a=numConstantNodes;a<numNodes;a++)
+        {
+            if (!inDegree[a])
+            {
+                depth[a] = 1;
+                feedForwardNodes.push_back(a);
+            }
+        }
+
+        for (int a=0;a<(int)feedForwardNodes.size();a++)
+        {
+            int node = feedForwardNodes[a];
+            feedForwardDepth = max(feedForwardDepth,depth[node]);
+
+            for (int b=outStart[node];b<outStart[node+1];b++)
+            {
+                int toNode = links[outLinks[b]].toNode;
+                depth[toNode] = max(depth[toNode],depth[node]+1);
+                if (!(--inDegree[toNode]))
+                {
+                    feedForwardNodes.push_back(toNode);
+                }
+            }
+        }
+
+        if ((int)feedForwardNodes.size() != numNodes-numConstantNodes)
+        {
+            //There is a cycle, fall back to the synchronous updates
+            feedForwardDepth = 0;
+            feedForwardNodes.clear();
+            return;
+        }
+
+        //Any order by depth is still topological, and nodes of the same depth
+        //don't depend on each other, so group them by activation function
+        //within each depth.  The node index breaks ties to keep the sort stable.
+        vector<pair<int,int> > &nodeKeys = buildScratch.nodeKeys;
+        nodeKeys.resize(feedForwardNodes.size());
+        for (int a=0;a<(int)feedForwardNodes.size();a++)
+        {
+            int node = feedForwardNodes[a];
+            nodeKeys[a] = pair<int,int>(depth[node]*ACTIVATION_FUNCTION_END+activationFunctions[node],node);
+        }
+        sort(nodeKeys.begin(),nodeKeys.end());
+        for (int a=0;a<(int)nodeKeys.size();a++)
+        {
+            feedForwardNodes[a] = nodeKeys[a].second;
+            if (a==0 || nodeKeys[a].first!=nodeKeys[a-1].first)
+            {
+                feedForwardGroups.push_back(ActivationGroup(activationFunctions[nodeKeys[a].second],a,a));
+            }
+            feedForwardGroups.back().end = a+1;
+        }
+
+        feedForward = true;
+    }
+
     /*NetworkNode *Network::getNode(const string name)
     {
     for (int a=0;a<nodes.size();a++)
@@ -378,42 +621,69 @@ namespace NEAT
     template<class Type>
     bool FastNetwork<Type>::hasNode(const string &nodeName)
     {
-        if (nodeNameToIndex.count(nodeName)>0)
+        if (getNodeIndex(nodeName)!=-1)
             return true;
         else
             return false;
     }
 
+    template<class Type>
+    int FastNetwork<Type>::getNodeIndex(const string &nodeName)
+    {
+        //Find the end of the run of nodes with this name.  If names repeat,
+        //the last node wins like it did when the names were kept in a map.
+        int low=0,high=numNodes;
+        while (low<high)
+        {
+            int middle = (low+high)/2;
+            if (nodeNames[nodeNameOrder[middle]].compare(nodeName)<=0)
+            {
+                low = middle+1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+
+        if (low==0 || nodeNames[nodeNameOrder[low-1]]!=nodeName)
+        {
+            return -1;
+        }
+        return nodeNameOrder[low-1];
+    }
+
     template<class Type>
     Type FastNetwork<Type>::getValue(const string &nodeName)
     {
-        if (!nodeNameToIndex.count(nodeName))
+        int nodeIndex = getNodeIndex(nodeName);
+        if (nodeIndex==-1)
         {
             cout << "ERROR: Could not find node named " << nodeName << endl;
             throw (string("ERROR: Could not find node named ") + string(nodeName) + string("\n"));
         }
         else
         {
-            return nodeValues[nodeNameToIndex[nodeName]];
+            return nodeValues[nodeIndex];
         }
     }
 
     template<class Type>
     void FastNetwork<Type>::setValue(const string &nodeName,Type newValue)
     {
-		map<string,int>::iterator it = nodeNameToIndex.find(nodeName);
-        if(it==nodeNameToIndex.end())
+		int nodeIndex = getNodeIndex(nodeName);
+        if(nodeIndex==-1)
         {
             throw CREATE_LOCATEDEXCEPTION_INFO( (string("ERROR: Could not find node named ") + string(nodeName) + string("\n")) );
         }
         else
         {
 #if DEBUG_NETWORK_UPDATE
-            cout << nodeName << " is at index " << nodeNameToIndex[nodeName] << endl;
+            cout << nodeName << " is at index " << nodeIndex << endl;
 #endif
-            nodeValues[it->second] = newValue;
+            nodeValues[nodeIndex] = newValue;
 #if DEBUG_NETWORK_UPDATE
-            cout << nodeNameToIndex[nodeName] << " set to " << newValue << endl;
+            cout << nodeIndex << " set to " << newValue << endl;
 #endif
         }
     }
@@ -421,15 +691,18 @@ namespace NEAT
     template<class Type>
     NetworkIndexedLink<Type> *FastNetwork<Type>::getLink(const string &fromNodeName,const string &toNodeName)
     {
-        int fromNodeIndex = nodeNameToIndex[fromNodeName];
-        int toNodeIndex = nodeNameToIndex[toNodeName];
+        int fromNodeIndex = getNodeIndex(fromNodeName);
+        int toNodeIndex = getNodeIndex(toNodeName);
 
-        if (!nodeNameToIndex.count(fromNodeName)||!nodeNameToIndex.count(toNodeName))
+        if (fromNodeIndex==-1||toNodeIndex==-1)
         {
             cout << "ERROR: Could not find node!" << endl;
             CREATE_PAUSE("PAUSE");
+            return NULL;
         }
 
+        buildNodeLinkMap();
+
         map<pair<int,int>,int>::iterator it = 
             nodeLinkMap.find(pair<int,int>(fromNodeIndex,toNodeIndex));
 
@@ -439,6 +712,7 @@ namespace NEAT
         }
         else
         {
+            linkWeightsChanged=true;
             return &links[it->second];
         }
     }
@@ -494,27 +768,45 @@ namespace NEAT
             //throw CREATE_LOCATEDEXCEPTION_INFO("THE NETWORK HAS BEEN UPDATED WHILE ALREADY ACTIVE!");
         }
 
+        refreshIncomingLinks();
+
+        bool signedActivation = Globals::getSingleton()->hasSignedActivation();
+        bool usingTanhSigmoid = Globals::getSingleton()->isUsingTanhSigmoid();
+        ActivationAccuracy accuracy = Globals::getSingleton()->getActivationAccuracy();
+
+        if (
+            compiled &&
+            accuracy==ACTIVATION_ACCURACY_EXACT &&
+            compiled->signedActivation==signedActivation &&
+            compiled->usingTanhSigmoid==usingTanhSigmoid
+            )
+        {
+            compiled->update(nodeValues,count,signedSigmoidTable,unsignedSigmoidTable);
+            return;
+        }
+
+        if (feedForward && count>=feedForwardDepth)
+        {
+            //Every node settles within count updates, so one pass in
+            //topological order gives the same result
+            updateFeedForward(signedActivation,usingTanhSigmoid,accuracy);
+            return;
+        }
+
         for (int a=0;a<count;a++)
         {
             /*for (int a=0;a<nodes.size();a++)
             {
             nodes[a]->computeNewValue();
             }*/
-            memset(nodeNewValues,0,sizeof(Type)*numNodes);
-
 #if DEBUG_NETWORK_UPDATE
             cout << "NumLinks: " << numLinks << endl;
 #endif
-            for (int a=0;a<numLinks;a++)
+            for (int a=numConstantNodes;a<numNodes;a++)
             {
+                nodeNewValues[a] = incomingLinks.sum(a,nodeValues,Type(0));
 #if DEBUG_NETWORK_UPDATE
-                cout << links[a].fromNode << "->" << links[a].toNode << " : " << links[a].weight << endl;
-                cout << "From value: " << nodeValues[links[a].fromNode] << endl;
-                cout << "Node value changed from " << nodeNewValues[links[a].toNode];
-#endif
-                nodeNewValues[links[a].toNode] += nodeValues[links[a].fromNode]*links[a].weight;
-#if DEBUG_NETWORK_UPDATE
-                cout << " to " << nodeNewValues[links[a].toNode] << endl;
+                cout << "Node " << a << " summed to " << nodeNewValues[a] << endl;
 #endif
             }
             //cout << "Done computing values.  Updating...\n";
@@ -532,18 +824,19 @@ namespace NEAT
             }
 #endif
 
-			bool signedActivation=false;
-
-			if (Globals::getSingleton()->hasSignedActivation())
-			{
-				signedActivation=true;
-			}
-
-			bool usingTanhSigmoid = Globals::getSingleton()->isUsingTanhSigmoid();
-
-            for (int a=numConstantNodes;a<numNodes;a++)
+            for (int b=0;b<(int)activationGroups.size();b++)
             {
-                nodeNewValues[a] = runActivationFunction(nodeNewValues[a],activationFunctions[a],signedActivation,usingTanhSigmoid);
+                const ActivationGroup &group = activationGroups[b];
+                runActivationKernel(
+                    group.function,
+                    &activationNodes[group.begin],
+                    group.end-group.begin,
+                    nodeNewValues,
+                    nodeNewValues,
+                    signedActivation,
+                    usingTanhSigmoid,
+                    accuracy
+                    );
             }
 
 #if DEBUG_NETWORK_UPDATE
@@ -578,6 +871,147 @@ namespace NEAT
         }
     }
 
+    template<class Type>
+    void FastNetwork<Type>::updateFeedForward(bool signedActivation,bool usingTanhSigmoid,ActivationAccuracy accuracy)
+    {
+        for (int a=0;a<(int)feedForwardGroups.size();a++)
+        {
+            const ActivationGroup &group = feedForwardGroups[a];
+
+            for (int b=group.begin;b<group.end;b++)
+            {
+                int node = feedForwardNodes[b];
+                nodeValues[node] = incomingLinks.sum(node,nodeValues,Type(0));
+            }
+
+            //The nodes in a group don't feed each other, so they can all be
+            //activated once their sums are done
+            runActivationKernel(
+                group.function,
+                &feedForwardNodes[group.begin],
+                group.end-group.begin,
+                nodeValues,
+                nodeValues,
+                signedActivation,
+                usingTanhSigmoid,
+                accuracy
+                );
+        }
+    }
+
+    template<class Type>
+    void FastNetwork<Type>::sumBatch(int node,const Type *values,Type *nodeBatch,int numSamples)
+    {
+        memset(nodeBatch,0,sizeof(Type)*numSamples);
+
+        int end = incomingLinks.getRowEnd(node);
+        for (int a=incomingLinks.getRowStart(node);a<end;a++)
+        {
+            const Type *fromBatch = &values[incomingLinks.getFromNode(a)*numSamples];
+            Type weight = incomingLinks.getWeight(a);
+            for (int b=0;b<numSamples;b++)
+            {
+                nodeBatch[b] += fromBatch[b]*weight;
+            }
+        }
+    }
+
+    template<class Type>
+    void FastNetwork<Type>::evaluateBatch(
+        int numSamples,
+        const vector<int> &inputIndices,
+        const Type * const *inputValues,
+        const vector<int> &outputIndices,
+        Type * const *outputValues
+        )
+    {
+        if (numSamples<=0)
+        {
+            return;
+        }
+
+        runBatch(numSamples,inputIndices,inputValues);
+
+        for (int a=0;a<(int)outputIndices.size();a++)
+        {
+            memcpy(outputValues[a],&batchValues[outputIndices[a]*numSamples],sizeof(Type)*numSamples);
+        }
+    }
+
+    template<class Type>
+    void FastNetwork<Type>::runBatch(int numSamples,const vector<int> &inputIndices,const Type * const *inputValues)
+    {
+        //Equivalent to reinitialize() followed by setting the inputs
+        batchValues.assign(numNodes*numSamples,Type(0));
+        for (int a=0;a<(int)inputIndices.size();a++)
+        {
+            if (inputIndices[a]==-1)
+            {
+                continue;
+            }
+            memcpy(&batchValues[inputIndices[a]*numSamples],inputValues[a],sizeof(Type)*numSamples);
+        }
+
+        refreshIncomingLinks();
+
+        bool signedActivation = Globals::getSingleton()->hasSignedActivation();
+        bool usingTanhSigmoid = Globals::getSingleton()->isUsingTanhSigmoid();
+        ActivationAccuracy accuracy = Globals::getSingleton()->getActivationAccuracy();
+
+        //Same number of updates as the first update() after reinitialize()
+        int count = 1 + Globals::getSingleton()->getExtraActivationUpdates();
+
+        if (
+            compiled &&
+            accuracy==ACTIVATION_ACCURACY_EXACT &&
+            compiled->signedActivation==signedActivation &&
+            compiled->usingTanhSigmoid==usingTanhSigmoid
+            )
+        {
+            compiled->updateBatch(&batchValues[0],numSamples,count,signedSigmoidTable,unsignedSigmoidTable);
+            return;
+        }
+
+        if (feedForward && count>=feedForwardDepth)
+        {
+            for (int a=0;a<(int)feedForwardNodes.size();a++)
+            {
+                int node = feedForwardNodes[a];
+                Type *nodeBatch = &batchValues[node*numSamples];
+                sumBatch(node,&batchValues[0],nodeBatch,numSamples);
+
+                runActivationKernel(activationFunctions[node],(const int*)NULL,numSamples,nodeBatch,nodeBatch,signedActivation,usingTanhSigmoid,accuracy);
+            }
+        }
+        else
+        {
+            batchNewValues.resize(numNodes*numSamples);
+
+            for (int a=0;a<count;a++)
+            {
+                for (int b=numConstantNodes;b<numNodes;b++)
+                {
+                    sumBatch(b,&batchValues[0],&batchNewValues[b*numSamples],numSamples);
+                }
+
+                for (int b=0;b<(int)activationNodes.size();b++)
+                {
+                    int node = activationNodes[b];
+                    runActivationKernel(
+                        activationFunctions[node],
+                        (const int*)NULL,
+                        numSamples,
+                        &batchNewValues[node*numSamples],
+                        &batchValues[node*numSamples],
+                        signedActivation,
+                        usingTanhSigmoid,
+                        accuracy
+                        );
+                }
+            }
+        }
+    }
+
     template<class Type>
     void FastNetwork<Type>::print()
     {
@@ -599,114 +1033,423 @@ namespace NEAT
         {
             links[a].weight = (Type)0.0;
         }
+        linkWeightsChanged=true;
     }
 
-    const float LEARNING_RATE = (0.5f);//(0.5f);
-
     template<class Type>
-    void FastNetwork<Type>::backProp(const vector<string> &nodeNames,const vector<Type> &correctedValues,bool perceptron)
+    void FastNetwork<Type>::buildBackPropAdjacency()
     {
-        set<int> fromNodes;
+        BackPropScratch &scratch = backPropScratch;
 
-        map<int,double> linkErrorTerms;
+        if (scratch.built)
+        {
+            return;
+        }
 
-        for(int a=0;a<(int)nodeNames.size();a++)
+        //Counting sorts by destination and by source, so gene order is kept
+        //within each node
+        scratch.inStart.assign(numNodes+1,0);
+        scratch.outStart.assign(numNodes+1,0);
+        for (int a=0;a<numLinks;a++)
+        {
+            scratch.inStart[links[a].toNode+1]++;
+            scratch.outStart[links[a].fromNode+1]++;
+        }
+        for (int a=0;a<numNodes;a++)
+        {
+            scratch.inStart[a+1] += scratch.inStart[a];
+            scratch.outStart[a+1] += scratch.outStart[a];
+        }
+
+        scratch.inLinks.resize(numLinks);
+        scratch.outLinks.resize(numLinks);
+
+        //Each row start is used as its fill position, which leaves it at the
+        //start of the next row, so the starts are shifted back afterwards
+        for (int a=0;a<numLinks;a++)
+        {
+            scratch.inLinks[scratch.inStart[links[a].toNode]++] = a;
+            scratch.outLinks[scratch.outStart[links[a].fromNode]++] = a;
+        }
+        for (int a=numNodes;a>0;a--)
+        {
+            scratch.inStart[a] = scratch.inStart[a-1];
+            scratch.outStart[a] = scratch.outStart[a-1];
+        }
+        scratch.inStart[0] = 0;
+        scratch.outStart[0] = 0;
+
+        scratch.velocities.assign(numLinks,Type(0.0));
+
+        scratch.built=true;
+    }
+
+    /**
+     * Adds delta to a batch total, taking the first delta as it is so a
+     * single sample gives exactly its own change
+     */
+    template<class Type>
+    inline void addWeightDelta(Type &total,char &totalSet,Type delta)
+    {
+        if (totalSet)
+        {
+            total += delta;
+        }
+        else
+        {
+            total = delta;
+            totalSet=1;
+        }
+    }
+
+    template<class Type>
+    void FastNetwork<Type>::backPropSamples(
+        int numSamples,
+        const Type *values,
+        const vector<int> &outputIndices,
+        const Type *targets,
+        bool perceptron,
+        Type learningRate,
+        bool applyNow
+        )
+    {
+        BackPropScratch &scratch = backPropScratch;
+
+        //linkErrors is only read where linkTouched is set
+        scratch.linkErrors.resize(numLinks*numSamples);
+        scratch.linkTouched.assign(numLinks*numSamples,0);
+        scratch.nodeMarked.assign(numNodes*numSamples,0);
+        scratch.linkListed.assign(numLinks,0);
+        scratch.nodeListed.assign(numNodes,0);
+        scratch.touchedLinks.clear();
+        scratch.markedNodes.clear();
+        scratch.sampleActive.resize(numSamples);
+        scratch.sampleSums.resize(numSamples);
+        scratch.sampleErrors.resize(numSamples);
+
+        char *active = &scratch.sampleActive[0];
+        Type *sums = &scratch.sampleSums[0];
+        Type *errors = &scratch.sampleErrors[0];
+
+        //Each output's error term is shared by every link into it.  The nodes
+        //feeding the outputs are marked for the hidden layer.
+        for (int a=0;a<(int)outputIndices.size();a++)
         {
-            int outputNodeIndex = nodeNameToIndex[nodeNames[a]];
+            int outputNodeIndex = outputIndices[a];
+            const Type *outputBatch = &values[outputNodeIndex*numSamples];
+            const Type *targetBatch = &targets[a*numSamples];
 
-            Type outputError = (Type)fabs(nodeValues[outputNodeIndex]-correctedValues[a]);
+            bool anyActive=false;
+            for (int s=0;s<numSamples;s++)
+            {
+                Type outputError = (Type)fabs(outputBatch[s]-targetBatch[s]);
 
-            if(fabs(outputError) < 1e-6)
+                //Samples whose error is sufficiently small are left alone
+                active[s] = !(fabs(outputError) < 1e-6);
+                anyActive = anyActive || active[s];
+            }
+
+            if (!anyActive)
             {
-                //The error is sufficiently small, bail
                 continue;
             }
 
-            //We begin by computing net2p.  We also store the from nodes so we can do backwards chaining
-            Type net2p=0.0;
-            for(int b=0;b<numLinks;b++)
+            int rowBegin = scratch.inStart[outputNodeIndex];
+            int rowEnd = scratch.inStart[outputNodeIndex+1];
+
+            //net2p
+            for (int s=0;s<numSamples;s++)
+            {
+                sums[s]=Type(0.0);
+            }
+            for (int e=rowBegin;e<rowEnd;e++)
             {
-                if(links[b].toNode == outputNodeIndex)
+                int fromNode = links[scratch.inLinks[e]].fromNode;
+                Type weight = links[scratch.inLinks[e]].weight;
+                const Type *fromBatch = &values[fromNode*numSamples];
+                char *marked = &scratch.nodeMarked[fromNode*numSamples];
+
+                for (int s=0;s<numSamples;s++)
+                {
+                    sums[s] += weight*fromBatch[s];
+                    marked[s] |= active[s];
+                }
+
+                if (!scratch.nodeListed[fromNode])
                 {
-                    net2p += links[b].weight*nodeValues[links[b].fromNode];
-                    fromNodes.insert(links[b].fromNode);
+                    scratch.nodeListed[fromNode]=1;
+                    scratch.markedNodes.push_back(fromNode);
                 }
             }
 
-            Type diff = 
-                (
-                correctedValues[a] - 
-                nodeValues[outputNodeIndex]
-            );
+            for (int s=0;s<numSamples;s++)
+            {
+                if (active[s])
+                {
+                    Type diff = targetBatch[s] - outputBatch[s];
 
-            Type errorTerm = 
-                diff * activationFunctionDerivative(net2p,activationFunctions[outputNodeIndex]);
+                    errors[s] = diff * activationFunctionDerivative(sums[s],activationFunctions[outputNodeIndex]);
+                }
+            }
 
-            //Now we can use net2p to compute the error function
-            for(int b=0;b<numLinks;b++)
+            for (int e=rowBegin;e<rowEnd;e++)
             {
-                if(links[b].toNode == outputNodeIndex)
+                int link = scratch.inLinks[e];
+                Type *linkError = &scratch.linkErrors[link*numSamples];
+                char *touched = &scratch.linkTouched[link*numSamples];
+
+                for (int s=0;s<numSamples;s++)
+                {
+                    if (active[s])
+                    {
+                        linkError[s] = errors[s];
+                        touched[s]=1;
+                    }
+                }
+
+                if (!scratch.linkListed[link])
                 {
-                    //We need to change the weight of this connection to correct any error.
-                    linkErrorTerms[b] = (Type)errorTerm;
+                    scratch.linkListed[link]=1;
+                    scratch.touchedLinks.push_back(link);
                 }
             }
         }
 
-        if(!perceptron)
+        if (!perceptron)
         {
-            for(set<int>::iterator fromNodeIterator = fromNodes.begin();fromNodeIterator != fromNodes.end();fromNodeIterator++)
+            //The marked nodes are trained in index order.  Every link out of
+            //a marked node takes part in the output layer changes, with an
+            //error term of 0 if it doesn't lead to an output.
+            sort(scratch.markedNodes.begin(),scratch.markedNodes.end());
+
+            for (int a=0;a<(int)scratch.markedNodes.size();a++)
             {
-                int outputNodeIndex = *fromNodeIterator;
+                int hiddenNodeIndex = scratch.markedNodes[a];
+                const char *marked = &scratch.nodeMarked[hiddenNodeIndex*numSamples];
+                int inBegin = scratch.inStart[hiddenNodeIndex];
+                int inEnd = scratch.inStart[hiddenNodeIndex+1];
+                int outBegin = scratch.outStart[hiddenNodeIndex];
+                int outEnd = scratch.outStart[hiddenNodeIndex+1];
+
+                //net1p
+                for (int s=0;s<numSamples;s++)
+                {
+                    sums[s]=Type(0.0);
+                    errors[s]=Type(0.0);
+                }
+                for (int e=inBegin;e<inEnd;e++)
+                {
+                    Type weight = links[scratch.inLinks[e]].weight;
+                    const Type *fromBatch = &values[links[scratch.inLinks[e]].fromNode*numSamples];
 
-                //We begin by computing net1p.
-                Type net1p=0.0f;
-                for(int a=0;a<numLinks;a++)
+                    for (int s=0;s<numSamples;s++)
+                    {
+                        sums[s] += (Type)(weight*fromBatch[s]);
+                    }
+                }
+
+                for (int e=outBegin;e<outEnd;e++)
                 {
-                    if(links[a].toNode == outputNodeIndex)
+                    int link = scratch.outLinks[e];
+                    Type weight = links[link].weight;
+                    Type *linkError = &scratch.linkErrors[link*numSamples];
+                    char *touched = &scratch.linkTouched[link*numSamples];
+
+                    for (int s=0;s<numSamples;s++)
+                    {
+                        if (marked[s])
+                        {
+                            if (!touched[s])
+                            {
+                                linkError[s]=Type(0.0);
+                                touched[s]=1;
+                            }
+                            errors[s] += (Type)(double(linkError[s])*weight);
+                        }
+                    }
+
+                    if (!scratch.linkListed[link])
                     {
-                        net1p += (Type)(links[a].weight*nodeValues[links[a].fromNode]);
+                        scratch.linkListed[link]=1;
+                        scratch.touchedLinks.push_back(link);
                     }
                 }
 
-                //Compute the error term
-                Type errorTerm = 0.0f;
+                for (int s=0;s<numSamples;s++)
+                {
+                    if (marked[s])
+                    {
+                        errors[s] *= activationFunctionDerivative(sums[s],activationFunctions[hiddenNodeIndex]);
+                    }
+                }
 
-                for(int b=0;b<numLinks;b++)
+                for (int e=inBegin;e<inEnd;e++)
                 {
-                    if(links[b].fromNode == outputNodeIndex)
+                    int link = scratch.inLinks[e];
+                    const Type *fromBatch = &values[links[link].fromNode*numSamples];
+
+                    for (int s=0;s<numSamples;s++)
                     {
-                        errorTerm += (Type)(linkErrorTerms[b]*links[b].weight);
+                        if (marked[s])
+                        {
+                            Type deltaWeight = (Type)
+                                learningRate * ( errors[s] * fromBatch[s]);
+
+                            if (applyNow)
+                            {
+                                links[link].weight += deltaWeight;
+                            }
+                            else
+                            {
+                                addWeightDelta(scratch.hiddenDeltas[link],scratch.hiddenDeltaSet[link],deltaWeight);
+                            }
+                        }
                     }
                 }
+            }
+        }
 
-                errorTerm *= activationFunctionDerivative(net1p,activationFunctions[outputNodeIndex]);
+        //Now the changes for the output layer links
+        for (int a=0;a<(int)scratch.touchedLinks.size();a++)
+        {
+            int link = scratch.touchedLinks[a];
+            const Type *fromBatch = &values[links[link].fromNode*numSamples];
+            const Type *linkError = &scratch.linkErrors[link*numSamples];
+            const char *touched = &scratch.linkTouched[link*numSamples];
 
-                for(int a=0;a<numLinks;a++)
+            for (int s=0;s<numSamples;s++)
+            {
+                if (touched[s])
                 {
-                    if(links[a].toNode == outputNodeIndex)
-                    {
-                        //We need to change the weight of this connection to correct any error.
-                        Type deltaWeight = (Type)
-                            LEARNING_RATE * ( errorTerm * nodeValues[links[a].fromNode]);
+                    Type deltaWeight = (Type)
+                        (double(learningRate) * ( double(linkError[s]) * fromBatch[s]));
 
-                        links[a].weight += deltaWeight;
+                    if (applyNow)
+                    {
+                        links[link].weight += deltaWeight;
+                    }
+                    else
+                    {
+                        addWeightDelta(scratch.outputDeltas[link],scratch.outputDeltaSet[link],deltaWeight);
                     }
                 }
             }
         }
+    }
 
-        //Now, we need to apply the link weight changes for the output layer links
-        for(
-            map< int,double >::iterator linkErrorIterator = linkErrorTerms.begin();
-            linkErrorIterator != linkErrorTerms.end();
-        linkErrorIterator++
-            )
+    const float LEARNING_RATE = (0.5f);//(0.5f);
+
+    template<class Type>
+    void FastNetwork<Type>::backProp(const vector<string> &nodeNames,const vector<Type> &correctedValues,bool perceptron)
+    {
+        linkWeightsChanged=true;
+
+        BackPropScratch &scratch = backPropScratch;
+
+        scratch.outputNodes.resize(nodeNames.size());
+        for(int a=0;a<(int)nodeNames.size();a++)
+        {
+            scratch.outputNodes[a] = getNodeIndex(nodeNames[a]);
+            if (scratch.outputNodes[a]==-1)
+            {
+                throw CREATE_LOCATEDEXCEPTION_INFO( (string("ERROR: Could not find node named ") + nodeNames[a] + string("\n")) );
+            }
+        }
+
+        if (nodeNames.empty())
         {
-            Type deltaWeight = (Type)
-                (LEARNING_RATE * ( linkErrorIterator->second * nodeValues[links[linkErrorIterator->first].fromNode]));
+            return;
+        }
+
+        buildBackPropAdjacency();
+
+        backPropSamples(
+            1,
+            nodeValues,
+            scratch.outputNodes,
+            &correctedValues[0],
+            perceptron,
+            (Type)LEARNING_RATE,
+            true
+            );
+    }
+
+    template<class Type>
+    void FastNetwork<Type>::backPropBatch(
+        int numSamples,
+        const vector<int> &inputIndices,
+        const Type * const *inputValues,
+        const vector<int> &outputIndices,
+        const Type * const *targetValues,
+        bool perceptron,
+        Type learningRate,
+        Type momentum
+        )
+    {
+        if (numSamples<=0)
+        {
+            return;
+        }
 
-            links[linkErrorIterator->first].weight += deltaWeight;
+        runBatch(numSamples,inputIndices,inputValues);
+
+        buildBackPropAdjacency();
+
+        BackPropScratch &scratch = backPropScratch;
+
+        scratch.targets.resize(outputIndices.size()*numSamples+1);
+        for (int a=0;a<(int)outputIndices.size();a++)
+        {
+            memcpy(&scratch.targets[a*numSamples],targetValues[a],sizeof(Type)*numSamples);
+        }
+
+        scratch.hiddenDeltas.resize(numLinks);
+        scratch.outputDeltas.resize(numLinks);
+        scratch.hiddenDeltaSet.assign(numLinks,0);
+        scratch.outputDeltaSet.assign(numLinks,0);
+
+        backPropSamples(
+            numSamples,
+            &batchValues[0],
+            outputIndices,
+            &scratch.targets[0],
+            perceptron,
+            learningRate,
+            false
+            );
+
+        linkWeightsChanged=true;
+
+        for (int a=0;a<numLinks;a++)
+        {
+            Type change = Type(0.0);
+            if (scratch.hiddenDeltaSet[a])
+            {
+                change += scratch.hiddenDeltas[a];
+            }
+            if (scratch.outputDeltaSet[a])
+            {
+                change += scratch.outputDeltas[a];
+            }
+
+            if (momentum==Type(0.0))
+            {
+                //Applied one layer at a time, as backProp does
+                if (scratch.hiddenDeltaSet[a])
+                {
+                    links[a].weight += scratch.hiddenDeltas[a];
+                }
+                if (scratch.outputDeltaSet[a])
+                {
+                    links[a].weight += scratch.outputDeltas[a];
+                }
+                scratch.velocities[a] = change;
+            }
+            else
+            {
+                scratch.velocities[a] = momentum*scratch.velocities[a] + change;
+                links[a].weight += scratch.velocities[a];
+            }
         }
     }
 
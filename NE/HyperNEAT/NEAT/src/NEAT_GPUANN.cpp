@@ -128,7 +128,10 @@ namespace NEAT
     extern double signedSigmoidTable[6001];
     extern double unsignedSigmoidTable[6001];
 
-    GPUANN *lastANNUpdated = NULL;
+    //Holding the last weights uploaded keeps them from being changed in
+    //place by setLink() or freed and their address reused
+    shared_ptr<const FastLayeredNetworkWeights<float> > lastWeightsUploaded;
+    vector<float> packedWeights1,packedWeights2;
 
     GPUANN::GPUANN(const vector<NetworkLayer<float> > &_layers)
         :
@@ -267,6 +270,29 @@ namespace NEAT
     {
     }
 
+    void GPUANN::getPackedWeights(int layerIndex,vector<float> &packedWeights)
+    {
+        PaddedMatrix<float> expandedWeights;
+        const PaddedMatrix<float> *layerWeights = &(weights->layerWeights[layerIndex][0]);
+
+        if(weights->weightsAreSparse[layerIndex][0])
+        {
+            const SparseMatrix<float> &sparse = weights->sparseWeights[layerIndex][0];
+            expandedWeights = PaddedMatrix<float>(sparse.numRows,sparse.numColumns);
+            sparse.expand(expandedWeights);
+            layerWeights = &expandedWeights;
+        }
+
+        packedWeights.resize(size_t(layerWeights->numRows)*layerWeights->numColumns);
+        for(int toNode=0;toNode<layerWeights->numRows;toNode++)
+        {
+            for(int fromNode=0;fromNode<layerWeights->numColumns;fromNode++)
+            {
+                packedWeights[size_t(toNode)*layerWeights->numColumns+fromNode] = (*layerWeights)(toNode,fromNode);
+            }
+        }
+    }
+
     void GPUANN::update()
     {
         boost::mutex::scoped_lock lock(gpuMutex);
@@ -300,11 +326,13 @@ namespace NEAT
         //ciErr1 |= clEnqueueWriteImage(cqCommandQue, cmLinkWeightAdjacencyList, CL_TRUE, usedOrigin, usedRegion, 0, 0, linkWeightAdjacencyListData, 0, NULL, NULL);
         ciErr1 |= clEnqueueWriteBuffer(cqCommandQue, cmActivationLevels, CL_FALSE, 0, sizeof(cl_int)*layers[0].nodeValues.size() , &(layers[0].nodeValues[0]) , 0, NULL, NULL);
 
-        if(lastANNUpdated!=this)
+        if(lastWeightsUploaded!=weights)
         {
-            lastANNUpdated=this;
-            ciErr1 |= clEnqueueWriteBuffer(cqCommandQue, cmFromLinkWeights1, CL_TRUE, 0, sizeof(cl_float)*layers[0].nodeValues.size()*layers[1].nodeValues.size() , &(layers[1].fromWeights[0][0]) , 0, NULL, NULL);
-            ciErr1 |= clEnqueueWriteBuffer(cqCommandQue, cmFromLinkWeights2, CL_TRUE, 0, sizeof(cl_float)*layers[1].nodeValues.size()*layers[2].nodeValues.size() , &(layers[2].fromWeights[0][0]) , 0, NULL, NULL);
+            lastWeightsUploaded=weights;
+            getPackedWeights(1,packedWeights1);
+            getPackedWeights(2,packedWeights2);
+            ciErr1 |= clEnqueueWriteBuffer(cqCommandQue, cmFromLinkWeights1, CL_TRUE, 0, sizeof(cl_float)*packedWeights1.size() , &(packedWeights1[0]) , 0, NULL, NULL);
+            ciErr1 |= clEnqueueWriteBuffer(cqCommandQue, cmFromLinkWeights2, CL_TRUE, 0, sizeof(cl_float)*packedWeights2.size() , &(packedWeights2[0]) , 0, NULL, NULL);
         }
 
         //printf( "clEnqueueWriteBuffer (SrcA and SrcB)...\n"); 
@@ -567,13 +567,23 @@ namespace NEAT
             {
                 if (Globals::getSingleton()->getRandom().getRandomDouble()<mutateLinkWeightsProb)
                 {
+                    //Each link gets three numbers, drawn all at once: one to
+                    //choose whether to mutate it, one to choose whether to
+                    //demolish it and one to perturb its weight by
+                    double mutationPower = Globals::getSingleton()->getParameterValue("MutationPower");
+                    vector<double> linkRandoms(links.size()*3);
+                    if (!links.empty())
+                    {
+                        Globals::getSingleton()->getRandom().getRandomDoubles(&linkRandoms[0],int(linkRandoms.size()));
+                    }
+
                     for (int a=0;a<(int)links.size();a++)
                     {
-                        if ((links[a].getAge()<adultLinkAge)||Globals::getSingleton()->getRandom().getRandomDouble()<mutateLinkProb)
+                        if ((links[a].getAge()<adultLinkAge)||linkRandoms[a*3]<mutateLinkProb)
                         {
-                            links[a].mutate();
+                            links[a].perturbWeight(mutationPower,linkRandoms[a*3+2]);
                         }
-                        else if(Globals::getSingleton()->getRandom().getRandomDouble()<mutateDemolishLinkProb)
+                        else if(linkRandoms[a*3+1]<mutateDemolishLinkProb)
                         {
                             links[a].setWeight(0);
                         }
@@ -587,6 +597,104 @@ namespace NEAT
 		isValid();
     }
 
+    template<class Gene>
+    static bool hasSmallerID(const Gene &gene1,const Gene &gene2)
+    {
+        return gene1.getID()<gene2.getID();
+    }
+
+    static inline int resolveID(const vector<int> &resolvedIDs,int id)
+    {
+        if (InnovationLog::isProvisionalID(id))
+        {
+            return resolvedIDs[id-InnovationLog::PROVISIONAL_ID_BASE];
+        }
+        return id;
+    }
+
+    void GeneticIndividual::resolveInnovations(const InnovationLog &innovations)
+    {
+        if (!innovations.getNumProvisionalIDs())
+        {
+            return;
+        }
+
+        vector<int> resolvedIDs(innovations.getNumProvisionalIDs(),-1);
+        const vector<InnovationLog::Event> &events = innovations.getEvents();
+
+        for (int a=0;a<(int)events.size();a++)
+        {
+            const InnovationLog::Event &event = events[a];
+            int index = event.id-InnovationLog::PROVISIONAL_ID_BASE;
+
+            switch (event.type)
+            {
+            case InnovationLog::EVENT_NEW_NODE:
+                resolvedIDs[index] = Globals::getSingleton()->createNodeID();
+                break;
+            case InnovationLog::EVENT_NODE_SPLIT:
+            {
+                //The same choice mutateAddNode() makes with real IDs
+                int nodeID = resolvedIDs[index];
+                int splitNodeID = Globals::getSingleton()->registerNodeSplit(
+                                      resolveID(resolvedIDs,event.fromNodeID),
+                                      resolveID(resolvedIDs,event.toNodeID),
+                                      nodeID
+                                  );
+                if (splitNodeID!=nodeID)
+                {
+                    bool hasSplitNode=false;
+                    for (int b=0;b<(int)nodes.size();b++)
+                    {
+                        if (nodes[b].getID()==splitNodeID)
+                        {
+                            hasSplitNode=true;
+                            break;
+                        }
+                    }
+
+                    if (!hasSplitNode)
+                    {
+                        resolvedIDs[index] = splitNodeID;
+                    }
+                }
+                break;
+            }
+            case InnovationLog::EVENT_NEW_LINK:
+            case InnovationLog::EVENT_NEW_UNIQUE_LINK:
+                resolvedIDs[index] = Globals::getSingleton()->getLinkInnovationID(
+                                         resolveID(resolvedIDs,event.fromNodeID),
+                                         resolveID(resolvedIDs,event.toNodeID),
+                                         event.type==InnovationLog::EVENT_NEW_UNIQUE_LINK
+                                     );
+                break;
+            default:
+                throw CREATE_LOCATEDEXCEPTION_INFO("Unknown innovation type!");
+            }
+        }
+
+        for (int a=0;a<(int)nodes.size();a++)
+        {
+            nodes[a].setID(resolveID(resolvedIDs,nodes[a].getID()));
+        }
+
+        for (int a=0;a<(int)links.size();a++)
+        {
+            links[a].setID(resolveID(resolvedIDs,links[a].getID()));
+            links[a].updateLegacy(resolveID(resolvedIDs,links[a].getFromNodeID()),resolveID(resolvedIDs,links[a].getToNodeID()));
+        }
+
+        sort(nodes.begin(),nodes.end(),hasSmallerID<GeneticNodeGene>);
+        sort(links.begin(),links.end(),hasSmallerID<GeneticLinkGene>);
+
+        for (int a=1;a<(int)links.size();a++)
+        {
+            if (links[a-1].getID()==links[a].getID())
+            {
+                throw CREATE_LOCATEDEXCEPTION_INFO("Oops, resolved two links to the same ID!");
+            }
+        }
+    }
 
     void GeneticIndividual::addNode(GeneticNodeGene node)
     {
@@ -814,14 +922,93 @@ namespace NEAT
         cout << endl;
     }
 
-    double GeneticIndividual::getCompatibility(shared_ptr<GeneticIndividual> other)
+    /**
+     * The links of a GeneticIndividual, for computeCompatibility()
+     */
+    class IndividualLinks
     {
-        GeneticIndividual *ind1 = this;
-        GeneticIndividual *ind2 = other.get();
+    protected:
+        const GeneticIndividual &individual;
+
+    public:
+        IndividualLinks(const GeneticIndividual &_individual)
+                :
+                individual(_individual)
+        {}
 
-        int numExcess = abs(int(ind1->getLinksCount())-int(ind2->getLinksCount()));
+        inline int getNumLinks() const
+        {
+            return individual.getLinksCount();
+        }
 
-        int maxIndividualSize = max(int(ind1->getLinksCount()),int(ind2->getLinksCount()));
+        inline int getID(int a) const
+        {
+            return individual.getLink(a)->getID();
+        }
+
+        inline double getWeight(int a) const
+        {
+            return individual.getLink(a)->getWeight();
+        }
+
+        inline double getFitness() const
+        {
+            return individual.getFitness();
+        }
+    };
+
+    /**
+     * The links of a CompactGenome, for computeCompatibility()
+     */
+    class CompactGenomeLinks
+    {
+    protected:
+        const CompactGenome &genome;
+
+    public:
+        CompactGenomeLinks(const CompactGenome &_genome)
+                :
+                genome(_genome)
+        {}
+
+        inline int getNumLinks() const
+        {
+            return int(genome.linkIDs.size());
+        }
+
+        inline int getID(int a) const
+        {
+            return genome.linkIDs[a];
+        }
+
+        inline double getWeight(int a) const
+        {
+            return genome.linkWeights[a];
+        }
+
+        inline double getFitness() const
+        {
+            return genome.fitness;
+        }
+    };
+
+    /**
+     * computeCompatibility: The compatibility formula, shared by
+     * GeneticIndividual::getCompatibility() and
+     * CompactGenome::getCompatibility().  Both genomes' links must be in
+     * ID order.
+     */
+    template<class Links>
+    static double computeCompatibility(
+        const Links &links1,
+        const Links &links2,
+        const CompatibilityCoefficients &coefficients
+    )
+    {
+        int numLinks1 = links1.getNumLinks();
+        int numLinks2 = links2.getNumLinks();
+
+        int numExcess = abs(numLinks1-numLinks2);
 
         int numDisjoint=0,numMatching=0;
 
@@ -829,55 +1016,47 @@ namespace NEAT
 
         int link1index = 0,link2index=0;
 
-        while (link1index<ind1->getLinksCount()&&link2index<ind2->getLinksCount())
+        while (link1index<numLinks1&&link2index<numLinks2)
         {
-            GeneticLinkGene *link1=NULL,*link2=NULL;
+            int link1ID = links1.getID(link1index);
+            int link2ID = links2.getID(link2index);
 
-            link1 = ind1->getLink(link1index);
-            link2 = ind2->getLink(link2index);
-
-            if (link2->getID()<link1->getID())
+            if (link2ID<link1ID)
             {
                 numDisjoint++;
                 link2index++;
             }
-            else if (link1->getID()<link2->getID())
+            else if (link1ID<link2ID)
             {
                 numDisjoint++;
                 link1index++;
             }
             else //both links have the same ID
             {
-                weightDiffTotal += fabs(link1->getWeight()-link2->getWeight());
+                weightDiffTotal += fabs(links1.getWeight(link1index)-links2.getWeight(link2index));
                 numMatching++;
                 link1index++;
                 link2index++;
             }
-
         }
 
         //Return the compatibility number using compatibility formula
         //Note that mut_diff_total/num_matching gives the AVERAGE
         //difference between mutation_nums for any two matching Genes
         //in the Genome
-        double disjointCoeff = Globals::getSingleton()->getParameterValue("DisjointCoefficient");
-        double excessCoeff = Globals::getSingleton()->getParameterValue("ExcessCoefficient");
-        double weightDiffCoeff = Globals::getSingleton()->getParameterValue("WeightDifferenceCoefficient");
-        double fitnessCoeff = Globals::getSingleton()->getParameterValue("FitnessCoefficient");
         //This is a hack that sets N to 1.  If N is small enough, 1 works.
-        maxIndividualSize=1;
+        int maxIndividualSize=1;
         double normalizedFitnessDifference;
-        normalizedFitnessDifference = (fitness/other->fitness);
+        normalizedFitnessDifference = (links1.getFitness()/links2.getFitness());
         if (normalizedFitnessDifference<1.0)
         {
             normalizedFitnessDifference = 1.0/normalizedFitnessDifference;
         }
-        //Normalizing for genome size
         double difference = (
-            disjointCoeff*(numDisjoint/double(maxIndividualSize))+
-            excessCoeff*(numExcess/double(maxIndividualSize))+
-            weightDiffCoeff*(weightDiffTotal/numMatching)+
-            fitnessCoeff*(normalizedFitnessDifference)
+            coefficients.disjointCoeff*(numDisjoint/double(maxIndividualSize))+
+            coefficients.excessCoeff*(numExcess/double(maxIndividualSize))+
+            coefficients.weightDiffCoeff*(weightDiffTotal/numMatching)+
+            coefficients.fitnessCoeff*(normalizedFitnessDifference)
             );
         return difference;
         //Look at disjointedness and excess in the absolute (ignoring size)
@@ -886,6 +1065,57 @@ namespace NEAT
         weightDiffCoeff*(weightDiffTotal/numMatching));*/
     }
 
+    double GeneticIndividual::getCompatibility(shared_ptr<GeneticIndividual> other)
+    {
+        return computeCompatibility(
+                   IndividualLinks(*this),
+                   IndividualLinks(*other),
+                   CompatibilityCoefficients()
+               );
+    }
+
+    CompatibilityCoefficients::CompatibilityCoefficients()
+    {
+        disjointCoeff = Globals::getSingleton()->getDisjointCoefficient();
+        excessCoeff = Globals::getSingleton()->getExcessCoefficient();
+        weightDiffCoeff = Globals::getSingleton()->getWeightDifferenceCoefficient();
+        fitnessCoeff = Globals::getSingleton()->getFitnessCoefficient();
+    }
+
+    CompactGenome::CompactGenome()
+            :
+            fitness(0)
+    {
+    }
+
+    CompactGenome::CompactGenome(const GeneticIndividual &individual)
+            :
+            fitness(individual.getFitness())
+    {
+        int numLinks = individual.getLinksCount();
+
+        linkIDs.resize(numLinks);
+        linkWeights.resize(numLinks);
+        for (int a=0;a<numLinks;a++)
+        {
+            const GeneticLinkGene *link = individual.getLink(a);
+            linkIDs[a] = link->getID();
+            linkWeights[a] = link->getWeight();
+        }
+    }
+
+    double CompactGenome::getCompatibility(
+        const CompactGenome &other,
+        const CompatibilityCoefficients &coefficients
+    ) const
+    {
+        return computeCompatibility(
+                   CompactGenomeLinks(*this),
+                   CompactGenomeLinks(other),
+                   coefficients
+               );
+    }
+
     bool GeneticIndividual::mutateAddLink()
     {
         GeneticNodeGene *fromNode=NULL,*toNode=NULL;
@@ -1063,6 +1293,27 @@ namespace NEAT
 
             GeneticNodeGene newNode = GeneticNodeGene("","HiddenNode",newPosition,randomActivation);
 
+            //If another individual split this link this generation, reuse
+            //its node so the new genes line up in crossover
+            int splitNodeID = Globals::getSingleton()->registerNodeSplit(tmpFromNodeID,tmpToNodeID,newNode.getID());
+            if (splitNodeID!=newNode.getID())
+            {
+                bool hasSplitNode=false;
+                for (int a=0;a<(int)nodes.size();a++)
+                {
+                    if (nodes[a].getID()==splitNodeID)
+                    {
+                        hasSplitNode=true;
+                        break;
+                    }
+                }
+
+                if (!hasSplitNode)
+                {
+                    newNode.setID(splitNodeID);
+                }
+            }
+
             GeneticLinkGene sourceLink = GeneticLinkGene(randomLink->getFromNodeID(),newNode.getID(),1.0);
             GeneticLinkGene destLink = GeneticLinkGene(newNode.getID(),randomLink->getToNodeID(),randomLink->getWeight()/2.0);
 
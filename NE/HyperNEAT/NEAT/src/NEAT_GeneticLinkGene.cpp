@@ -93,7 +93,15 @@ namespace NEAT
             int mod=1;
             //mod = max(20-age,2)/2;
             double mutationPower = mod*Globals::getSingleton()->getParameterValue("MutationPower");
-            weight += mutationPower*(2.0*(Globals::getSingleton()->getRandom().getRandomDouble()-0.5));
+            perturbWeight(mutationPower,Globals::getSingleton()->getRandom().getRandomDouble());
+        }
+    }
+
+    void GeneticLinkGene::perturbWeight(double mutationPower,double randomDouble)
+    {
+        if(!fixed)
+        {
+            weight += mutationPower*(2.0*(randomDouble-0.5));
 
             if (weight>5)
                 weight=5;
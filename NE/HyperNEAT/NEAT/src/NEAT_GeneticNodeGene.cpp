@@ -17,8 +17,8 @@ namespace NEAT
         ActivationFunction _activationFunction
     )
             :
-            name(_name),
-            type(_type),
+            name(StringTable::intern(_name)),
+            type(StringTable::intern(_type)),
             drawingPosition(_drawingPosition),
             topologyFrozen(false),
             activationFunction(_activationFunction)
@@ -60,8 +60,8 @@ namespace NEAT
         ActivationFunction _activationFunction
     )
             :
-            name(_name),
-            type(_type),
+            name(StringTable::intern(_name)),
+            type(StringTable::intern(_type)),
             drawingPosition(_drawingPosition),
             topologyFrozen(_topologyFrozen),
             activationFunction(_activationFunction)
@@ -111,8 +111,8 @@ namespace NEAT
             GeneticGene(nodeElementPtr),
             activationFunction(ACTIVATION_FUNCTION_SIGMOID)
     {
-        name = nodeElementPtr->Attribute("Name");
-        type = nodeElementPtr->Attribute("Type");
+        name = StringTable::intern(nodeElementPtr->Attribute("Name"));
+        type = StringTable::intern(nodeElementPtr->Attribute("Type"));
 
         nodeElementPtr->Attribute("DrawingPosition",&drawingPosition);
 
@@ -138,22 +138,27 @@ namespace NEAT
     {
         int actVal;
 
-        istr >> name >> type >> drawingPosition >> topologyFrozen >> actVal;
+        string tmpName,tmpType;
+
+        istr >> tmpName >> tmpType >> drawingPosition >> topologyFrozen >> actVal;
 
         activationFunction = (ActivationFunction)actVal;
 
-        if (name==string("__NO_NAME__"))
+        if (tmpName==string("__NO_NAME__"))
         {
-            name = string("");
+            tmpName = string("");
         }
 
-        if (type==string("__NO_TYPE__"))
+        if (tmpType==string("__NO_TYPE__"))
         {
-            type = string("");
+            tmpType = string("");
         }
 
+        name = StringTable::intern(tmpName);
+        type = StringTable::intern(tmpType);
+
 #if DEBUG_GENETIC_NODE_GENE
-        cout << "Name: " << name << " Type: " << type << " Draw Position: " << drawingPosition
+        cout << "Name: " << *name << " Type: " << *type << " Draw Position: " << drawingPosition
         << " Activation Function: " << actVal << endl;
 #endif
     }
@@ -174,8 +179,8 @@ namespace NEAT
     void GeneticNodeGene::dump(TiXmlElement *XMLnode)
     {
         GeneticGene::dump(XMLnode);
-        XMLnode->SetAttribute("Name",name);
-        XMLnode->SetAttribute("Type",type);
+        XMLnode->SetAttribute("Name",*name);
+        XMLnode->SetAttribute("Type",*type);
         XMLnode->SetDoubleAttribute("DrawingPosition",drawingPosition);
         XMLnode->SetAttribute("TopologyFrozen",(int)topologyFrozen);
         XMLnode->SetAttribute("ActivationFunction",(int)activationFunction);
@@ -185,21 +190,21 @@ namespace NEAT
     {
         GeneticGene::dump(ostr);
 
-        string tmpName = name;
+        string tmpName = *name;
 
         if (tmpName.length()==0)
         {
             tmpName = string("__NO_NAME__");
         }
 
-        string tmpType = type;
+        string tmpType = *type;
 
         if (tmpType.length()==0)
         {
             tmpType = string("__NO_TYPE__");
         }
 
-        ostr << tmpName << ' ' << type << ' ' << drawingPosition << ' ' << topologyFrozen << ' '
+        ostr << tmpName << ' ' << *type << ' ' << drawingPosition << ' ' << topologyFrozen << ' '
             << ((int)activationFunction) << ' ';
     }
 
@@ -9,10 +9,123 @@
 #endif
 
 #include "NEAT_GeneticIndividual.h"
+#include "NEAT_GeneticSpecies.h"
 #include "NEAT_Random.h"
 
+#include <boost/thread/thread.hpp>
+
 namespace NEAT
 {
+    /**
+     *  One thread's share of speciate(): it snapshots the individuals in
+     *  [begin,end) and finds the first of the earlier species each one is
+     *  compatible with
+     */
+    class SpeciationTask
+    {
+    public:
+        const vector<shared_ptr<GeneticIndividual> > *individuals;
+        const vector<CompactGenome> *representatives;
+        const CompatibilityCoefficients *coefficients;
+        double compatThreshold;
+        int begin,end;
+
+        vector<CompactGenome> *genomes;
+        vector<int> *firstMatches;
+
+        string error;
+
+        void run()
+        {
+            for (int a=begin;a<end;a++)
+            {
+                (*genomes)[a] = CompactGenome(*(*individuals)[a]);
+
+                (*firstMatches)[a] = -1;
+                for (int b=0;b<(int)representatives->size();b++)
+                {
+                    double compatibility = (*representatives)[b].getCompatibility((*genomes)[a],*coefficients);
+                    if (compatibility<compatThreshold)
+                    {
+                        (*firstMatches)[a] = b;
+                        break;
+                    }
+                }
+            }
+        }
+
+        void runInThread()
+        {
+            try
+            {
+                run();
+            }
+            catch (const std::exception &ex)
+            {
+                error = ex.what();
+            }
+            catch (...)
+            {
+                error = "Unknown error while speciating";
+            }
+        }
+    };
+
+    /**
+     *  One thread's share of produceNextGeneration(): it makes the babies
+     *  in [begin,end).  Each baby draws from its own stream of the
+     *  generation's offspring stream and logs its innovations instead of
+     *  taking IDs, so a baby comes out the same whichever thread makes it.
+     */
+    class ReproductionTask
+    {
+    public:
+        const vector<BabyParents> *babyParents;
+        const Random *offspringRandom;
+        int begin,end;
+
+        vector<shared_ptr<GeneticIndividual> > *babies;
+        vector<InnovationLog> *innovations;
+
+        string error;
+
+        void run()
+        {
+            try
+            {
+                for (int a=begin;a<end;a++)
+                {
+                    RandomStreamScope babyRandom(offspringRandom->getStream(a));
+                    Globals::getSingleton()->setThreadInnovations(&(*innovations)[a]);
+
+                    (*babies)[a] = (*babyParents)[a].makeBaby();
+                }
+            }
+            catch (...)
+            {
+                Globals::getSingleton()->setThreadInnovations(NULL);
+                throw;
+            }
+
+            Globals::getSingleton()->setThreadInnovations(NULL);
+        }
+
+        void runInThread()
+        {
+            try
+            {
+                run();
+            }
+            catch (const std::exception &ex)
+            {
+                error = ex.what();
+            }
+            catch (...)
+            {
+                error = "Unknown error while making babies";
+            }
+        }
+    };
 
     GeneticPopulation::GeneticPopulation()
             : onGeneration(0)
@@ -244,20 +357,95 @@ namespace NEAT
     void GeneticPopulation::speciate()
     {
         double compatThreshold = Globals::getSingleton()->getParameterValue("CompatibilityThreshold");
+        CompatibilityCoefficients coefficients;
 
-        for (int a=0;a<generations[onGeneration]->getIndividualCount();a++)
+        int numIndividuals = generations[onGeneration]->getIndividualCount();
+        vector<shared_ptr<GeneticIndividual> > individuals(numIndividuals);
+        for (int a=0;a<numIndividuals;a++)
         {
-            shared_ptr<GeneticIndividual> individual = generations[onGeneration]->getIndividual(a);
+            individuals[a] = generations[onGeneration]->getIndividual(a);
+        }
+
+        //The species from earlier generations come first in the search, and
+        //their best individuals don't change while speciating, so each
+        //individual's first match among them can be found independently
+        int numOldSpecies = (int)species.size();
+        vector<CompactGenome> representatives(numOldSpecies);
+        for (int b=0;b<numOldSpecies;b++)
+        {
+            representatives[b] = CompactGenome(*species[b]->getBestIndividual());
+        }
+
+        vector<CompactGenome> genomes(numIndividuals);
+        vector<int> firstMatches(numIndividuals,-1);
+
+        //Don't start threads for only a few individuals each
+        int numTasks = max(1,min(Globals::getSingleton()->getEvolutionThreads(),numIndividuals/32));
+        vector<SpeciationTask> tasks(numTasks);
+        for (int t=0;t<numTasks;t++)
+        {
+            tasks[t].individuals = &individuals;
+            tasks[t].representatives = &representatives;
+            tasks[t].coefficients = &coefficients;
+            tasks[t].compatThreshold = compatThreshold;
+            tasks[t].begin = int((long long)numIndividuals*t/numTasks);
+            tasks[t].end = int((long long)numIndividuals*(t+1)/numTasks);
+            tasks[t].genomes = &genomes;
+            tasks[t].firstMatches = &firstMatches;
+        }
+
+        if (numTasks==1)
+        {
+            tasks[0].run();
+        }
+        else
+        {
+            vector<boost::thread*> threads(numTasks-1);
+            for (int t=1;t<numTasks;t++)
+            {
+                threads[t-1] = new boost::thread(boost::bind(&SpeciationTask::runInThread,&tasks[t]));
+            }
+
+            tasks[0].runInThread();
+
+            for (int t=1;t<numTasks;t++)
+            {
+                threads[t-1]->join();
+                delete threads[t-1];
+            }
+
+            for (int t=0;t<numTasks;t++)
+            {
+                if (tasks[t].error.length())
+                {
+                    throw CREATE_LOCATEDEXCEPTION_INFO(tasks[t].error);
+                }
+            }
+        }
+
+        //The individuals that didn't match an earlier species are checked
+        //against the species made during this pass, in order
+        vector<CompactGenome> newRepresentatives;
+        for (int a=0;a<numIndividuals;a++)
+        {
+            shared_ptr<GeneticIndividual> individual = individuals[a];
+
+            if (firstMatches[a]>=0)
+            {
+                //Found a compatible species
+                individual->setSpeciesID(species[firstMatches[a]]->getID());
+                continue;
+            }
 
             bool makeNewSpecies=true;
 
-            for (int b=0;b<(int)species.size();b++)
+            for (int b=0;b<(int)newRepresentatives.size();b++)
             {
-                double compatibility = species[b]->getBestIndividual()->getCompatibility(individual);
+                double compatibility = newRepresentatives[b].getCompatibility(genomes[a],coefficients);
                 if (compatibility<compatThreshold)
                 {
                     //Found a compatible species
-                    individual->setSpeciesID(species[b]->getID());
+                    individual->setSpeciesID(species[numOldSpecies+b]->getID());
                     makeNewSpecies=false;
                     break;
                 }
@@ -268,6 +456,14 @@ namespace NEAT
                 //Make a new species.  The process of making a new speceis sets the ID for the individual.
                 shared_ptr<GeneticSpecies> newSpecies(new GeneticSpecies(individual));
                 species.push_back(newSpecies);
+                newRepresentatives.push_back(genomes[a]);
+
+                int id = newSpecies->getID();
+                if (id>=(int)speciesByID.size())
+                {
+                    speciesByID.resize(id+1);
+                }
+                speciesByID[id] = newSpecies;
             }
         }
 
@@ -338,6 +534,7 @@ namespace NEAT
             if (species[a]->getIndividualCount()==0)
             {
                 extinctSpecies.push_back(species[a]);
+                speciesByID[species[a]->getID()].reset();
                 species.erase(species.begin()+a);
                 a--;
             }
@@ -354,6 +551,66 @@ namespace NEAT
         generations[onGeneration]->sortByFitness();
     }
 
+    void GeneticPopulation::makeBabies(
+        const vector<BabyParents> &babyParents,
+        vector<shared_ptr<GeneticIndividual> > &babies
+    )
+    {
+        int numBabies = (int)babyParents.size();
+        babies.resize(numBabies);
+        vector<InnovationLog> innovations(numBabies);
+
+        //Don't start threads for only a few babies each
+        int numTasks = max(1,min(Globals::getSingleton()->getEvolutionThreads(),numBabies/16));
+        Random offspringRandom = Globals::getSingleton()->getRandom().getStream(RANDOM_STREAM_OFFSPRING,onGeneration);
+        vector<ReproductionTask> tasks(numTasks);
+        for (int t=0;t<numTasks;t++)
+        {
+            tasks[t].babyParents = &babyParents;
+            tasks[t].offspringRandom = &offspringRandom;
+            tasks[t].begin = int((long long)numBabies*t/numTasks);
+            tasks[t].end = int((long long)numBabies*(t+1)/numTasks);
+            tasks[t].babies = &babies;
+            tasks[t].innovations = &innovations;
+        }
+
+        if (numTasks==1)
+        {
+            tasks[0].run();
+        }
+        else
+        {
+            vector<boost::thread*> threads(numTasks-1);
+            for (int t=1;t<numTasks;t++)
+            {
+                threads[t-1] = new boost::thread(boost::bind(&ReproductionTask::runInThread,&tasks[t]));
+            }
+
+            tasks[0].runInThread();
+
+            for (int t=1;t<numTasks;t++)
+            {
+                threads[t-1]->join();
+                delete threads[t-1];
+            }
+
+            for (int t=0;t<numTasks;t++)
+            {
+                if (tasks[t].error.length())
+                {
+                    throw CREATE_LOCATEDEXCEPTION_INFO(tasks[t].error);
+                }
+            }
+        }
+
+        //The innovations get their IDs in the babies' order, so the IDs
+        //don't depend on which thread finished first
+        for (int a=0;a<numBabies;a++)
+        {
+            babies[a]->resolveInnovations(innovations[a]);
+        }
+    }
+
     void GeneticPopulation::produceNextGeneration()
     {
 #ifdef EPLEX_INTERNAL
@@ -422,8 +679,8 @@ namespace NEAT
             cout << "Species ID: " << species[a]->getID() << " Age: " << species[a]->getAge() << " last improv. age: " << species[a]->getAgeOfLastImprovement() << " Fitness: " << species[a]->getFitness() << "*" << species[a]->getMultiplier() << "=" << species[a]->getAdjustedFitness() <<  " Size: " << int(species[a]->getIndividualCount()) << " Offspring: " << int(species[a]->getOffspringCount()) << endl;
         }
 
-        //This is the new generation
-        vector<shared_ptr<GeneticIndividual> > babies;
+        //The parents of the new generation
+        vector<BabyParents> babyParents;
 
         double totalIndividualFitness=0;
 
@@ -467,7 +724,7 @@ namespace NEAT
                         mutateChampion = true;
                     else
                         mutateChampion = false;
-                    babies.push_back(shared_ptr<GeneticIndividual>(new GeneticIndividual(ind,mutateChampion)));
+                    babyParents.push_back(BabyParents(ind,mutateChampion));
                     species->decrementOffspringCount();
                 }
 
@@ -489,17 +746,25 @@ namespace NEAT
         cout << "# of Species: " << int(species.size()) << endl;
         cout << "compat threshold: " << Globals::getSingleton()->getParameterValue("CompatibilityThreshold") << endl;
 
+        Random speciesRandoms = Globals::getSingleton()->getRandom().getStream(RANDOM_STREAM_SPECIES,onGeneration);
         for (int a=0;a<(int)species.size();a++)
         {
             //cout << "Making babies\n";
-            species[a]->makeBabies(babies);
+            //Each species chooses parents from its own stream, so its
+            //choices don't depend on how many numbers the others drew
+            RandomStreamScope speciesRandom(speciesRandoms.getStream(species[a]->getID()));
+            species[a]->makeBabies(babyParents);
         }
-        if ((int)babies.size()!=generations[onGeneration]->getIndividualCount())
+        if ((int)babyParents.size()!=generations[onGeneration]->getIndividualCount())
         {
             cout << "Population size changed!\n";
             throw CREATE_LOCATEDEXCEPTION_INFO("Population size changed!");
         }
 
+        //This is the new generation
+        vector<shared_ptr<GeneticIndividual> > babies;
+        makeBabies(babyParents,babies);
+
         //cout << "Making new generation\n";
         shared_ptr<GeneticGeneration> newGeneration(generations[onGeneration]->produceNextGeneration(babies,onGeneration+1));
         //cout << "Done Making new generation!\n";
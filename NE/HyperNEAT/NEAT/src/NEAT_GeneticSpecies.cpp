@@ -86,7 +86,17 @@ namespace NEAT
         }
     }
 
-    void GeneticSpecies::makeBabies(vector<shared_ptr<GeneticIndividual> > &babies)
+    shared_ptr<GeneticIndividual> BabyParents::makeBaby() const
+    {
+        if (parent2)
+        {
+            return shared_ptr<GeneticIndividual>(new GeneticIndividual(parent1,parent2));
+        }
+
+        return shared_ptr<GeneticIndividual>(new GeneticIndividual(parent1,mutate));
+    }
+
+    void GeneticSpecies::makeBabies(vector<BabyParents> &babies)
     {
         int lastIndex = int(Globals::getSingleton()->getParameterValue("SurvivalThreshold")*currentIndividuals.size());
 
@@ -104,7 +114,7 @@ namespace NEAT
                 //Something messed up, bail
                 int parent = 0;
                 shared_ptr<GeneticIndividual> ind = currentIndividuals[parent];
-                babies.push_back(shared_ptr<GeneticIndividual>(new GeneticIndividual(ind,true)));
+                babies.push_back(BabyParents(ind,true));
                 offspringCount--;
                 continue;
             }
@@ -114,7 +124,7 @@ namespace NEAT
             {
                 int parent = Globals::getSingleton()->getRandom().getRandomWithinRange(0,int(lastIndex));
                 shared_ptr<GeneticIndividual> ind = currentIndividuals[parent];
-                babies.push_back(shared_ptr<GeneticIndividual>(new GeneticIndividual(ind,true)));
+                babies.push_back(BabyParents(ind,true));
                 offspringCount--;
             }
             else
@@ -145,11 +155,11 @@ namespace NEAT
 
                 if (parent1==parent2)
                 {
-                    babies.push_back(shared_ptr<GeneticIndividual>(new GeneticIndividual(parent1,true)));
+                    babies.push_back(BabyParents(parent1,true));
                 }
                 else
                 {
-                    babies.push_back(shared_ptr<GeneticIndividual>(new GeneticIndividual(parent1,parent2)));
+                    babies.push_back(BabyParents(parent1,parent2));
                 }
                 offspringCount--;
             }
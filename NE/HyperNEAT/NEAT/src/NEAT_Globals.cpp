@@ -8,6 +8,7 @@
 #define DEBUG_NEAT_GLOBALS (0)
 
 #include <boost/algorithm/string.hpp>
+#include <boost/thread/thread.hpp>
 
 const char* activationFunctionNames[ACTIVATION_FUNCTION_END] =
 {
@@ -26,34 +27,99 @@ namespace NEAT
     double signedSigmoidTable[6001];
     double unsignedSigmoidTable[6001];
 
+    //Parameter files saved before the coefficients were configurable
+    //don't have them, so these are also the fallbacks
+    static const double DEFAULT_DISJOINT_COEFFICIENT = 2.0;
+    static const double DEFAULT_EXCESS_COEFFICIENT = 2.0;
+    static const double DEFAULT_WEIGHT_DIFFERENCE_COEFFICIENT = 1.0;
+    static const double DEFAULT_FITNESS_COEFFICIENT = 0.0;
+
     Globals *Globals::singleton = NULL;
     void Globals::assignNodeID(GeneticNodeGene *testNode)
     {
-        testNode->setID(generateNodeID());
+        InnovationLog *innovations = threadInnovations.get();
+        if (innovations)
+        {
+            testNode->setID(innovations->logNode());
+            return;
+        }
+
+        testNode->setID(createNodeID());
     }
 
     void Globals::assignLinkID(GeneticLinkGene *testLink,bool ignoreHistory)
     {
+        InnovationLog *innovations = threadInnovations.get();
+        if (innovations)
+        {
+            testLink->setID(innovations->logLink(testLink->getFromNodeID(),testLink->getToNodeID(),ignoreHistory));
+            return;
+        }
+
+        testLink->setID(getLinkInnovationID(testLink->getFromNodeID(),testLink->getToNodeID(),ignoreHistory));
+    }
+
+    int Globals::createNodeID()
+    {
+        boost::mutex::scoped_lock scoped_lock(innovationMutex);
+
+        return generateNodeID();
+    }
+
+    int Globals::getLinkInnovationID(int fromNodeID,int toNodeID,bool ignoreHistory)
+    {
+        boost::mutex::scoped_lock scoped_lock(innovationMutex);
+
         if (ignoreHistory)
         {
-            testLink->setID(generateLinkID());
+            return generateLinkID();
         }
-        for (int a=0;a<(int)linkGenesThisGeneration.size();a++)
+
+        int linkID = linkInnovations.find(fromNodeID,toNodeID);
+        if (linkID==-1)
         {
-            shared_ptr<GeneticLinkGene> link = linkGenesThisGeneration[a];
-            if (link->getFromNodeID()==testLink->getFromNodeID()&&link->getToNodeID()==testLink->getToNodeID())
-            {
-                testLink->setID( link->getID() );
-                return;
-            }
+            linkID = generateLinkID();
+            linkInnovations.insert(fromNodeID,toNodeID,linkID);
+        }
+        return linkID;
+    }
+
+    int Globals::registerNodeSplit(int fromNodeID,int toNodeID,int nodeID)
+    {
+        InnovationLog *innovations = threadInnovations.get();
+        if (innovations)
+        {
+            //Other babies' splits are only known once the log is resolved
+            return innovations->logNodeSplit(fromNodeID,toNodeID,nodeID);
+        }
+
+        boost::mutex::scoped_lock scoped_lock(innovationMutex);
+
+        int splitNodeID = nodeSplits.find(fromNodeID,toNodeID);
+        if (splitNodeID==-1)
+        {
+            nodeSplits.insert(fromNodeID,toNodeID,nodeID);
+            return nodeID;
+        }
+        return splitNodeID;
+    }
+
+    void Globals::setThreadInnovations(InnovationLog *innovations)
+    {
+        //release() never deletes, the thread owns the log
+        threadInnovations.release();
+        if (innovations)
+        {
+            threadInnovations.reset(innovations);
         }
-        testLink->setID(generateLinkID());
-        linkGenesThisGeneration.push_back(shared_ptr<GeneticLinkGene>(new GeneticLinkGene(*testLink)));
     }
 
     void Globals::clearLinkHistory()
     {
-        linkGenesThisGeneration.clear();
+        boost::mutex::scoped_lock scoped_lock(innovationMutex);
+
+        linkInnovations.clear();
+        nodeSplits.clear();
     }
 
     int Globals::generateSpeciesID()
@@ -101,10 +167,10 @@ namespace NEAT
 
         parameters.insert("PopulationSize",120.0);
         parameters.insert("MaxGenerations",600.0);
-        parameters.insert("DisjointCoefficient",2.0);
-        parameters.insert("ExcessCoefficient", 2.0);
-        parameters.insert("WeightDifferenceCoefficient", 1.0);
-        parameters.insert("FitnessCoefficient", 0.0);
+        parameters.insert("DisjointCoefficient",DEFAULT_DISJOINT_COEFFICIENT);
+        parameters.insert("ExcessCoefficient", DEFAULT_EXCESS_COEFFICIENT);
+        parameters.insert("WeightDifferenceCoefficient", DEFAULT_WEIGHT_DIFFERENCE_COEFFICIENT);
+        parameters.insert("FitnessCoefficient", DEFAULT_FITNESS_COEFFICIENT);
         parameters.insert("CompatibilityThreshold", 6.0);
         parameters.insert("CompatibilityModifier", 0.3);
         parameters.insert("SpeciesSizeTarget", 8.0);
@@ -269,6 +335,16 @@ namespace NEAT
         random = Random(newSeed);
     }
 
+    void Globals::setThreadRandom(Random *streamRandom)
+    {
+        //release() never deletes, the thread owns the generator
+        threadRandom.release();
+        if (streamRandom)
+        {
+            threadRandom.reset(streamRandom);
+        }
+    }
+
     void Globals::dump(TiXmlElement *root)
     {
         root->SetAttribute("ActualRandomSeed",getRandom().getSeed());
@@ -328,5 +404,56 @@ namespace NEAT
 		{
 			useTanhSigmoid = false;
 		}
+
+		cout << "Compatibility coefficients" << endl;
+		disjointCoefficient = hasParameterValue("DisjointCoefficient") ? getParameterValue("DisjointCoefficient") : DEFAULT_DISJOINT_COEFFICIENT;
+		excessCoefficient = hasParameterValue("ExcessCoefficient") ? getParameterValue("ExcessCoefficient") : DEFAULT_EXCESS_COEFFICIENT;
+		weightDifferenceCoefficient = hasParameterValue("WeightDifferenceCoefficient") ? getParameterValue("WeightDifferenceCoefficient") : DEFAULT_WEIGHT_DIFFERENCE_COEFFICIENT;
+		fitnessCoefficient = hasParameterValue("FitnessCoefficient") ? getParameterValue("FitnessCoefficient") : DEFAULT_FITNESS_COEFFICIENT;
+
+		cout << "ActivationAccuracy" << endl;
+		activationAccuracy = ACTIVATION_ACCURACY_EXACT;
+		if(hasParameterValue("ActivationAccuracy"))
+		{
+			int accuracy = int(getParameterValue("ActivationAccuracy"));
+			if(accuracy<ACTIVATION_ACCURACY_EXACT || accuracy>=ACTIVATION_ACCURACY_END)
+			{
+				throw CREATE_LOCATEDEXCEPTION_INFO("ERROR: Invalid ActivationAccuracy!");
+			}
+			activationAccuracy = ActivationAccuracy(accuracy);
+		}
+
+		cout << "NetworkCompileThreshold" << endl;
+		networkCompileThreshold = 0;
+		if(hasParameterValue("NetworkCompileThreshold"))
+		{
+			networkCompileThreshold = max(0,int(getParameterValue("NetworkCompileThreshold")));
+		}
+
+		cout << "SubstrateCacheSize" << endl;
+		substrateCacheSize = 0;
+		if(hasParameterValue("SubstrateCacheSize"))
+		{
+			substrateCacheSize = max(0,int(getParameterValue("SubstrateCacheSize")));
+		}
+
+		cout << "SparseLayerDensity" << endl;
+		sparseLayerDensity = 0.2;
+		if(hasParameterValue("SparseLayerDensity"))
+		{
+			sparseLayerDensity = getParameterValue("SparseLayerDensity");
+		}
+
+		cout << "EvolutionThreads" << endl;
+		evolutionThreads = 0;
+		if(hasParameterValue("EvolutionThreads"))
+		{
+			evolutionThreads = int(getParameterValue("EvolutionThreads"));
+		}
+		if(evolutionThreads<=0)
+		{
+			//0 means one thread per core
+			evolutionThreads = max(1,int(boost::thread::hardware_concurrency()));
+		}
 	}
 }
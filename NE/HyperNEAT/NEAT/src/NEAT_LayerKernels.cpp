@@ -0,0 +1,974 @@
+#include "NEAT_Defines.h"
+
+#include "NEAT_LayerKernels.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define NEAT_LAYER_KERNELS_X86 (1)
+#else
+#define NEAT_LAYER_KERNELS_X86 (0)
+#endif
+
+#if NEAT_LAYER_KERNELS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+//The AVX kernels are compiled for their instruction sets function by
+//function, so the rest of the library keeps the baseline flags
+#if defined(__GNUC__)
+#define NEAT_TARGET_SSE2 __attribute__((target("sse2")))
+#define NEAT_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define NEAT_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#else
+#define NEAT_TARGET_SSE2
+#define NEAT_TARGET_AVX2
+#define NEAT_TARGET_AVX512
+#endif
+
+namespace NEAT
+{
+    /*
+     * Columns are walked in blocks of this many values, so the part of the
+     * input being used (8KB of floats) stays in L1 while every row streams
+     * past it
+     */
+    static const int COLUMN_BLOCK = 2048;
+
+    static SimdLevel detectSimdLevel()
+    {
+        SimdLevel level = SIMD_LEVEL_SCALAR;
+
+#if NEAT_LAYER_KERNELS_X86
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info,0);
+        int maxLeaf = info[0];
+
+        __cpuid(info,1);
+        bool sse2 = ((info[3]>>26)&1)!=0;
+        bool fma = ((info[2]>>12)&1)!=0;
+        bool osxsave = ((info[2]>>27)&1)!=0;
+        bool avx = ((info[2]>>28)&1)!=0;
+
+        bool avx2 = false;
+        bool avx512 = false;
+        if (maxLeaf>=7)
+        {
+            __cpuidex(info,7,0);
+            avx2 = ((info[1]>>5)&1)!=0;
+            avx512 = ((info[1]>>16)&1)!=0;
+        }
+
+        //The OS has to save the wider registers too
+        unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+        bool ymmState = (xcr0&0x6)==0x6;
+        bool zmmState = (xcr0&0xe6)==0xe6;
+
+        if (sse2)
+            level = SIMD_LEVEL_SSE2;
+        if (level==SIMD_LEVEL_SSE2 && avx && avx2 && fma && ymmState)
+            level = SIMD_LEVEL_AVX2;
+        if (level==SIMD_LEVEL_AVX2 && avx512 && zmmState)
+            level = SIMD_LEVEL_AVX512;
+#else
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("sse2"))
+            level = SIMD_LEVEL_SSE2;
+        if (level==SIMD_LEVEL_SSE2 && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            level = SIMD_LEVEL_AVX2;
+        if (level==SIMD_LEVEL_AVX2 && __builtin_cpu_supports("avx512f"))
+            level = SIMD_LEVEL_AVX512;
+#endif
+#endif
+
+        const char *requested = getenv("NEAT_SIMD");
+        if (requested)
+        {
+            const char *names[SIMD_LEVEL_END] = {"scalar","sse2","avx2","avx512"};
+            for (int a=0;a<SIMD_LEVEL_END;a++)
+            {
+                if (string(requested)==names[a] && a<level)
+                {
+                    level = SimdLevel(a);
+                }
+            }
+        }
+
+        return level;
+    }
+
+    SimdLevel getSimdLevel()
+    {
+        static SimdLevel level = detectSimdLevel();
+        return level;
+    }
+
+    template<class Type>
+    inline void applySignedSigmoid(Type *values,int count)
+    {
+        for (int a=0;a<count;a++)
+        {
+            values[a] = (2.0f / (1.0f + exp(-values[a]))) - 1.0f;
+        }
+    }
+
+    /*
+     * Every kernel walks the columns in blocks, then the rows in blocks,
+     * then the samples, so one block of weights is reused from the cache
+     * by every sample of a batch before the next one is loaded
+     */
+
+    template<class Type>
+    static void multiplyLayerScalar(
+        const PaddedMatrix<Type> &weights,
+        int numSamples,
+        const Type *inputs,
+        int inputStride,
+        Type *outputs,
+        int outputStride,
+        bool activate
+        )
+    {
+        int rowStride = weights.rowStride;
+
+        for (int columnStart=0;columnStart<rowStride;columnStart+=COLUMN_BLOCK)
+        {
+            int columnEnd = min(rowStride,columnStart+COLUMN_BLOCK);
+
+            for (int row=0;row<weights.paddedRows;row+=4)
+            {
+                const Type *rowWeights = &weights.values[size_t(row)*rowStride];
+
+                for (int sample=0;sample<numSamples;sample++)
+                {
+                    const Type *input = inputs+size_t(sample)*inputStride;
+                    Type *output = outputs+size_t(sample)*outputStride;
+
+                    Type sum0=0,sum1=0,sum2=0,sum3=0;
+                    for (int column=columnStart;column<columnEnd;column++)
+                    {
+                        Type value = input[column];
+                        sum0 += rowWeights[column]*value;
+                        sum1 += rowWeights[rowStride+column]*value;
+                        sum2 += rowWeights[2*rowStride+column]*value;
+                        sum3 += rowWeights[3*rowStride+column]*value;
+                    }
+                    output[row] += sum0;
+                    output[row+1] += sum1;
+                    output[row+2] += sum2;
+                    output[row+3] += sum3;
+                }
+            }
+        }
+
+        if (activate)
+        {
+            for (int sample=0;sample<numSamples;sample++)
+            {
+                applySignedSigmoid(outputs+size_t(sample)*outputStride,weights.paddedRows);
+            }
+        }
+    }
+
+    /*
+     * The sparse kernels walk the rows, then the samples, so each row's
+     * weights and columns are reused by every sample of a batch
+     */
+
+    template<class Type>
+    static void multiplySparseLayerScalar(
+        const SparseMatrix<Type> &weights,
+        int numSamples,
+        const Type *inputs,
+        int inputStride,
+        Type *outputs,
+        int outputStride,
+        bool activate
+        )
+    {
+        for (int row=0;row<weights.paddedRows;row++)
+        {
+            int begin = weights.rowStarts[row];
+            int end = weights.rowStarts[row+1];
+
+            for (int sample=0;sample<numSamples;sample++)
+            {
+                const Type *input = inputs+size_t(sample)*inputStride;
+
+                Type sum=0;
+                for (int a=begin;a<end;a++)
+                {
+                    sum += weights.values[a]*input[weights.columns[a]];
+                }
+                outputs[size_t(sample)*outputStride+row] += sum;
+            }
+        }
+
+        if (activate)
+        {
+            for (int sample=0;sample<numSamples;sample++)
+            {
+                applySignedSigmoid(outputs+size_t(sample)*outputStride,weights.paddedRows);
+            }
+        }
+    }
+
+#if NEAT_LAYER_KERNELS_X86
+    /*
+     * The vector sigmoids compute 2/(1+e^-x)-1 with the same exp as
+     * fastExp in NEAT_ActivationKernels.cpp: e^x = 2^i * 2^f with
+     * i=round(x*log2(e)) and a degree 6 polynomial for 2^f.
+     */
+    NEAT_TARGET_SSE2 static inline __m128 fastSignedSigmoidSSE2(__m128 x)
+    {
+        x = _mm_sub_ps(_mm_setzero_ps(),x);
+        x = _mm_max_ps(x,_mm_set1_ps(-87.0f));
+        x = _mm_min_ps(x,_mm_set1_ps(87.0f));
+
+        __m128 t = _mm_mul_ps(x,_mm_set1_ps(1.44269504f));
+        __m128i i = _mm_sub_epi32(_mm_cvttps_epi32(_mm_add_ps(t,_mm_set1_ps(126.5f))),_mm_set1_epi32(126));
+        __m128 f = _mm_sub_ps(t,_mm_cvtepi32_ps(i));
+
+        __m128 p = _mm_set1_ps(0.000154035304f);
+        p = _mm_add_ps(_mm_mul_ps(p,f),_mm_set1_ps(0.00133335581f));
+        p = _mm_add_ps(_mm_mul_ps(p,f),_mm_set1_ps(0.00961812911f));
+        p = _mm_add_ps(_mm_mul_ps(p,f),_mm_set1_ps(0.0555041087f));
+        p = _mm_add_ps(_mm_mul_ps(p,f),_mm_set1_ps(0.240226507f));
+        p = _mm_add_ps(_mm_mul_ps(p,f),_mm_set1_ps(0.693147181f));
+        p = _mm_add_ps(_mm_mul_ps(p,f),_mm_set1_ps(1.0f));
+
+        __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(i,_mm_set1_epi32(127)),23));
+        __m128 e = _mm_mul_ps(p,scale);
+
+        return _mm_sub_ps(_mm_div_ps(_mm_set1_ps(2.0f),_mm_add_ps(_mm_set1_ps(1.0f),e)),_mm_set1_ps(1.0f));
+    }
+
+    NEAT_TARGET_SSE2 static void multiplyLayerSSE2(
+        const PaddedMatrix<float> &weights,
+        int numSamples,
+        const float *inputs,
+        int inputStride,
+        float *outputs,
+        int outputStride,
+        bool activate,
+        bool fastActivation
+        )
+    {
+        int rowStride = weights.rowStride;
+
+        for (int columnStart=0;columnStart<rowStride;columnStart+=COLUMN_BLOCK)
+        {
+            int columnEnd = min(rowStride,columnStart+COLUMN_BLOCK);
+            bool lastBlock = (columnEnd==rowStride);
+
+            for (int row=0;row<weights.paddedRows;row+=4)
+            {
+                const float *rowWeights = &weights.values[size_t(row)*rowStride];
+
+                for (int sample=0;sample<numSamples;sample++)
+                {
+                    const float *input = inputs+size_t(sample)*inputStride;
+                    float *output = outputs+size_t(sample)*outputStride;
+
+                    __m128 sum0 = _mm_setzero_ps();
+                    __m128 sum1 = _mm_setzero_ps();
+                    __m128 sum2 = _mm_setzero_ps();
+                    __m128 sum3 = _mm_setzero_ps();
+                    for (int column=columnStart;column<columnEnd;column+=4)
+                    {
+                        __m128 value = _mm_load_ps(input+column);
+                        sum0 = _mm_add_ps(sum0,_mm_mul_ps(_mm_load_ps(rowWeights+column),value));
+                        sum1 = _mm_add_ps(sum1,_mm_mul_ps(_mm_load_ps(rowWeights+rowStride+column),value));
+                        sum2 = _mm_add_ps(sum2,_mm_mul_ps(_mm_load_ps(rowWeights+2*rowStride+column),value));
+                        sum3 = _mm_add_ps(sum3,_mm_mul_ps(_mm_load_ps(rowWeights+3*rowStride+column),value));
+                    }
+
+                    //Transposing leaves lane k of the total with row k's sum
+                    _MM_TRANSPOSE4_PS(sum0,sum1,sum2,sum3);
+                    __m128 total = _mm_add_ps(_mm_add_ps(sum0,sum1),_mm_add_ps(sum2,sum3));
+                    total = _mm_add_ps(total,_mm_load_ps(output+row));
+
+                    if (activate && lastBlock && fastActivation)
+                    {
+                        total = fastSignedSigmoidSSE2(total);
+                    }
+
+                    _mm_store_ps(output+row,total);
+                }
+            }
+        }
+
+        if (activate && !fastActivation)
+        {
+            for (int sample=0;sample<numSamples;sample++)
+            {
+                applySignedSigmoid(outputs+size_t(sample)*outputStride,weights.paddedRows);
+            }
+        }
+    }
+
+    NEAT_TARGET_AVX2 static inline __m256 fastSignedSigmoidAVX2(__m256 x)
+    {
+        x = _mm256_sub_ps(_mm256_setzero_ps(),x);
+        x = _mm256_max_ps(x,_mm256_set1_ps(-87.0f));
+        x = _mm256_min_ps(x,_mm256_set1_ps(87.0f));
+
+        __m256 t = _mm256_mul_ps(x,_mm256_set1_ps(1.44269504f));
+        __m256i i = _mm256_sub_epi32(_mm256_cvttps_epi32(_mm256_add_ps(t,_mm256_set1_ps(126.5f))),_mm256_set1_epi32(126));
+        __m256 f = _mm256_sub_ps(t,_mm256_cvtepi32_ps(i));
+
+        __m256 p = _mm256_set1_ps(0.000154035304f);
+        p = _mm256_fmadd_ps(p,f,_mm256_set1_ps(0.00133335581f));
+        p = _mm256_fmadd_ps(p,f,_mm256_set1_ps(0.00961812911f));
+        p = _mm256_fmadd_ps(p,f,_mm256_set1_ps(0.0555041087f));
+        p = _mm256_fmadd_ps(p,f,_mm256_set1_ps(0.240226507f));
+        p = _mm256_fmadd_ps(p,f,_mm256_set1_ps(0.693147181f));
+        p = _mm256_fmadd_ps(p,f,_mm256_set1_ps(1.0f));
+
+        __m256 scale = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(i,_mm256_set1_epi32(127)),23));
+        __m256 e = _mm256_mul_ps(p,scale);
+
+        return _mm256_sub_ps(_mm256_div_ps(_mm256_set1_ps(2.0f),_mm256_add_ps(_mm256_set1_ps(1.0f),e)),_mm256_set1_ps(1.0f));
+    }
+
+    /**
+     * sumRowsAVX2: Returns the 8 horizontal sums of sums[0..7], in order
+     */
+    NEAT_TARGET_AVX2 static inline __m256 sumRowsAVX2(const __m256 *sums)
+    {
+        __m256 sum01 = _mm256_hadd_ps(sums[0],sums[1]);
+        __m256 sum23 = _mm256_hadd_ps(sums[2],sums[3]);
+        __m256 sum45 = _mm256_hadd_ps(sums[4],sums[5]);
+        __m256 sum67 = _mm256_hadd_ps(sums[6],sums[7]);
+
+        //Each 128 bit lane now holds one partial sum per row
+        __m256 sum0123 = _mm256_hadd_ps(sum01,sum23);
+        __m256 sum4567 = _mm256_hadd_ps(sum45,sum67);
+
+        return _mm256_add_ps(
+                   _mm256_permute2f128_ps(sum0123,sum4567,0x20),
+                   _mm256_permute2f128_ps(sum0123,sum4567,0x31)
+               );
+    }
+
+    NEAT_TARGET_AVX2 static void multiplyLayerAVX2(
+        const PaddedMatrix<float> &weights,
+        int numSamples,
+        const float *inputs,
+        int inputStride,
+        float *outputs,
+        int outputStride,
+        bool activate,
+        bool fastActivation
+        )
+    {
+        int rowStride = weights.rowStride;
+
+        for (int columnStart=0;columnStart<rowStride;columnStart+=COLUMN_BLOCK)
+        {
+            int columnEnd = min(rowStride,columnStart+COLUMN_BLOCK);
+            bool lastBlock = (columnEnd==rowStride);
+
+            for (int row=0;row<weights.paddedRows;row+=8)
+            {
+                const float *rowWeights = &weights.values[size_t(row)*rowStride];
+
+                for (int sample=0;sample<numSamples;sample++)
+                {
+                    const float *input = inputs+size_t(sample)*inputStride;
+                    float *output = outputs+size_t(sample)*outputStride;
+
+                    __m256 sums[8];
+                    for (int a=0;a<8;a++)
+                    {
+                        sums[a] = _mm256_setzero_ps();
+                    }
+                    for (int column=columnStart;column<columnEnd;column+=8)
+                    {
+                        __m256 value = _mm256_load_ps(input+column);
+                        for (int a=0;a<8;a++)
+                        {
+                            sums[a] = _mm256_fmadd_ps(_mm256_load_ps(rowWeights+a*rowStride+column),value,sums[a]);
+                        }
+                    }
+
+                    __m256 total = _mm256_add_ps(sumRowsAVX2(sums),_mm256_load_ps(output+row));
+
+                    if (activate && lastBlock && fastActivation)
+                    {
+                        total = fastSignedSigmoidAVX2(total);
+                    }
+
+                    _mm256_store_ps(output+row,total);
+                }
+            }
+        }
+
+        if (activate && !fastActivation)
+        {
+            for (int sample=0;sample<numSamples;sample++)
+            {
+                applySignedSigmoid(outputs+size_t(sample)*outputStride,weights.paddedRows);
+            }
+        }
+    }
+
+    /**
+     * addHalvesAVX512: Returns the low 8 lanes of x plus the high 8.  The
+     * halves come from zero-masked extracts, because the plain extract and
+     * cast start from an undefined vector that GCC warns about.
+     */
+    NEAT_TARGET_AVX512 static inline __m256 addHalvesAVX512(__m512 x)
+    {
+        __m512d halves = _mm512_castps_pd(x);
+        return _mm256_add_ps(
+                   _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xF,halves,1)),
+                   _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xF,halves,0))
+               );
+    }
+
+    NEAT_TARGET_AVX512 static void multiplyLayerAVX512(
+        const PaddedMatrix<float> &weights,
+        int numSamples,
+        const float *inputs,
+        int inputStride,
+        float *outputs,
+        int outputStride,
+        bool activate,
+        bool fastActivation
+        )
+    {
+        int rowStride = weights.rowStride;
+
+        for (int columnStart=0;columnStart<rowStride;columnStart+=COLUMN_BLOCK)
+        {
+            int columnEnd = min(rowStride,columnStart+COLUMN_BLOCK);
+            bool lastBlock = (columnEnd==rowStride);
+
+            for (int row=0;row<weights.paddedRows;row+=8)
+            {
+                const float *rowWeights = &weights.values[size_t(row)*rowStride];
+
+                for (int sample=0;sample<numSamples;sample++)
+                {
+                    const float *input = inputs+size_t(sample)*inputStride;
+                    float *output = outputs+size_t(sample)*outputStride;
+
+                    __m512 sums[8];
+                    for (int a=0;a<8;a++)
+                    {
+                        sums[a] = _mm512_setzero_ps();
+                    }
+                    for (int column=columnStart;column<columnEnd;column+=16)
+                    {
+                        __m512 value = _mm512_load_ps(input+column);
+                        for (int a=0;a<8;a++)
+                        {
+                            sums[a] = _mm512_fmadd_ps(_mm512_load_ps(rowWeights+a*rowStride+column),value,sums[a]);
+                        }
+                    }
+
+                    //Fold each row's 16 lanes to 8 and finish like the AVX2 kernel
+                    __m256 halfSums[8];
+                    for (int a=0;a<8;a++)
+                    {
+                        halfSums[a] = addHalvesAVX512(sums[a]);
+                    }
+
+                    __m256 total = _mm256_add_ps(sumRowsAVX2(halfSums),_mm256_load_ps(output+row));
+
+                    if (activate && lastBlock && fastActivation)
+                    {
+                        total = fastSignedSigmoidAVX2(total);
+                    }
+
+                    _mm256_store_ps(output+row,total);
+                }
+            }
+        }
+
+        if (activate && !fastActivation)
+        {
+            for (int sample=0;sample<numSamples;sample++)
+            {
+                applySignedSigmoid(outputs+size_t(sample)*outputStride,weights.paddedRows);
+            }
+        }
+    }
+
+    /*
+     * SSE2 has no gather instruction, so the inputs are gathered into a
+     * vector four at a time by hand
+     */
+    NEAT_TARGET_SSE2 static void multiplySparseLayerSSE2(
+        const SparseMatrix<float> &weights,
+        int numSamples,
+        const float *inputs,
+        int inputStride,
+        float *outputs,
+        int outputStride,
+        bool activate,
+        bool fastActivation
+        )
+    {
+        const int *columns = weights.columns.empty() ? NULL : &weights.columns[0];
+        const float *values = weights.values.empty() ? NULL : &weights.values[0];
+
+        for (int row=0;row<weights.paddedRows;row++)
+        {
+            int begin = weights.rowStarts[row];
+            int end = weights.rowStarts[row+1];
+            int vectorEnd = begin+((end-begin)&~3);
+
+            for (int sample=0;sample<numSamples;sample++)
+            {
+                const float *input = inputs+size_t(sample)*inputStride;
+
+                __m128 sum = _mm_setzero_ps();
+                for (int a=begin;a<vectorEnd;a+=4)
+                {
+                    __m128 value = _mm_set_ps(input[columns[a+3]],input[columns[a+2]],input[columns[a+1]],input[columns[a]]);
+                    sum = _mm_add_ps(sum,_mm_mul_ps(_mm_loadu_ps(values+a),value));
+                }
+
+                sum = _mm_add_ps(sum,_mm_movehl_ps(sum,sum));
+                sum = _mm_add_ss(sum,_mm_shuffle_ps(sum,sum,1));
+
+                float total = _mm_cvtss_f32(sum);
+                for (int a=vectorEnd;a<end;a++)
+                {
+                    total += values[a]*input[columns[a]];
+                }
+                outputs[size_t(sample)*outputStride+row] += total;
+            }
+        }
+
+        if (activate)
+        {
+            for (int sample=0;sample<numSamples;sample++)
+            {
+                float *output = outputs+size_t(sample)*outputStride;
+                if (fastActivation)
+                {
+                    for (int row=0;row<weights.paddedRows;row+=4)
+                    {
+                        _mm_store_ps(output+row,fastSignedSigmoidSSE2(_mm_load_ps(output+row)));
+                    }
+                }
+                else
+                {
+                    applySignedSigmoid(output,weights.paddedRows);
+                }
+            }
+        }
+    }
+
+    NEAT_TARGET_AVX2 static void multiplySparseLayerAVX2(
+        const SparseMatrix<float> &weights,
+        int numSamples,
+        const float *inputs,
+        int inputStride,
+        float *outputs,
+        int outputStride,
+        bool activate,
+        bool fastActivation
+        )
+    {
+        const int *columns = weights.columns.empty() ? NULL : &weights.columns[0];
+        const float *values = weights.values.empty() ? NULL : &weights.values[0];
+
+        for (int row=0;row<weights.paddedRows;row++)
+        {
+            int begin = weights.rowStarts[row];
+            int end = weights.rowStarts[row+1];
+            int vectorEnd = begin+((end-begin)&~7);
+
+            for (int sample=0;sample<numSamples;sample++)
+            {
+                const float *input = inputs+size_t(sample)*inputStride;
+
+                __m256 sum = _mm256_setzero_ps();
+                for (int a=begin;a<vectorEnd;a+=8)
+                {
+                    __m256i index = _mm256_loadu_si256((const __m256i*)(columns+a));
+                    sum = _mm256_fmadd_ps(_mm256_loadu_ps(values+a),_mm256_i32gather_ps(input,index,4),sum);
+                }
+
+                __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum),_mm256_extractf128_ps(sum,1));
+                half = _mm_add_ps(half,_mm_movehl_ps(half,half));
+                half = _mm_add_ss(half,_mm_shuffle_ps(half,half,1));
+
+                float total = _mm_cvtss_f32(half);
+                for (int a=vectorEnd;a<end;a++)
+                {
+                    total += values[a]*input[columns[a]];
+                }
+                outputs[size_t(sample)*outputStride+row] += total;
+            }
+        }
+
+        if (activate)
+        {
+            for (int sample=0;sample<numSamples;sample++)
+            {
+                float *output = outputs+size_t(sample)*outputStride;
+                if (fastActivation)
+                {
+                    for (int row=0;row<weights.paddedRows;row+=8)
+                    {
+                        _mm256_store_ps(output+row,fastSignedSigmoidAVX2(_mm256_load_ps(output+row)));
+                    }
+                }
+                else
+                {
+                    applySignedSigmoid(output,weights.paddedRows);
+                }
+            }
+        }
+    }
+
+    NEAT_TARGET_AVX512 static void multiplySparseLayerAVX512(
+        const SparseMatrix<float> &weights,
+        int numSamples,
+        const float *inputs,
+        int inputStride,
+        float *outputs,
+        int outputStride,
+        bool activate,
+        bool fastActivation
+        )
+    {
+        const int *columns = weights.columns.empty() ? NULL : &weights.columns[0];
+        const float *values = weights.values.empty() ? NULL : &weights.values[0];
+
+        for (int row=0;row<weights.paddedRows;row++)
+        {
+            int begin = weights.rowStarts[row];
+            int end = weights.rowStarts[row+1];
+
+            for (int sample=0;sample<numSamples;sample++)
+            {
+                const float *input = inputs+size_t(sample)*inputStride;
+
+                //The last partial vector is masked, so no column past the
+                //row's end is read
+                __m512 sum = _mm512_setzero_ps();
+                for (int a=begin;a<end;a+=16)
+                {
+                    __mmask16 mask = (end-a>=16) ? __mmask16(0xffff) : __mmask16((1<<(end-a))-1);
+                    __m512i index = _mm512_maskz_loadu_epi32(mask,columns+a);
+                    __m512 value = _mm512_mask_i32gather_ps(_mm512_setzero_ps(),mask,index,input,4);
+                    sum = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask,values+a),value,sum);
+                }
+
+                //Sum the lanes in the order _mm512_reduce_add_ps does
+                __m256 half = addHalvesAVX512(sum);
+                __m128 quarter = _mm_add_ps(_mm256_extractf128_ps(half,1),_mm256_castps256_ps128(half));
+                quarter = _mm_add_ps(quarter,_mm_shuffle_ps(quarter,quarter,_MM_SHUFFLE(1,0,3,2)));
+                outputs[size_t(sample)*outputStride+row] +=
+                    _mm_cvtss_f32(quarter)+_mm_cvtss_f32(_mm_shuffle_ps(quarter,quarter,_MM_SHUFFLE(1,1,1,1)));
+            }
+        }
+
+        if (activate)
+        {
+            for (int sample=0;sample<numSamples;sample++)
+            {
+                float *output = outputs+size_t(sample)*outputStride;
+                if (fastActivation)
+                {
+                    for (int row=0;row<weights.paddedRows;row+=8)
+                    {
+                        _mm256_store_ps(output+row,fastSignedSigmoidAVX2(_mm256_load_ps(output+row)));
+                    }
+                }
+                else
+                {
+                    applySignedSigmoid(output,weights.paddedRows);
+                }
+            }
+        }
+    }
+
+    NEAT_TARGET_SSE2 static void activateLayerSSE2(float *values,int count)
+    {
+        for (int a=0;a<count;a+=4)
+        {
+            _mm_store_ps(values+a,fastSignedSigmoidSSE2(_mm_load_ps(values+a)));
+        }
+    }
+
+    NEAT_TARGET_AVX2 static void activateLayerAVX2(float *values,int count)
+    {
+        for (int a=0;a<count;a+=8)
+        {
+            _mm256_store_ps(values+a,fastSignedSigmoidAVX2(_mm256_load_ps(values+a)));
+        }
+    }
+#endif
+
+    /**
+     * multiplyLayerVector: Runs the widest vector kernel the machine has.
+     * Returns false if there is none for this type.
+     */
+    template<class Type>
+    static inline bool multiplyLayerVector(
+        const PaddedMatrix<Type> &weights,
+        int numSamples,
+        const Type *inputs,
+        int inputStride,
+        Type *outputs,
+        int outputStride,
+        bool activate,
+        bool fastActivation
+        )
+    {
+        return false;
+    }
+
+    static inline bool multiplyLayerVector(
+        const PaddedMatrix<float> &weights,
+        int numSamples,
+        const float *inputs,
+        int inputStride,
+        float *outputs,
+        int outputStride,
+        bool activate,
+        bool fastActivation
+        )
+    {
+#if NEAT_LAYER_KERNELS_X86
+        switch (getSimdLevel())
+        {
+        case SIMD_LEVEL_AVX512:
+            multiplyLayerAVX512(weights,numSamples,inputs,inputStride,outputs,outputStride,activate,fastActivation);
+            return true;
+        case SIMD_LEVEL_AVX2:
+            multiplyLayerAVX2(weights,numSamples,inputs,inputStride,outputs,outputStride,activate,fastActivation);
+            return true;
+        case SIMD_LEVEL_SSE2:
+            multiplyLayerSSE2(weights,numSamples,inputs,inputStride,outputs,outputStride,activate,fastActivation);
+            return true;
+        default:
+            break;
+        }
+#endif
+
+        return false;
+    }
+
+    template<class Type>
+    static inline bool multiplySparseLayerVector(
+        const SparseMatrix<Type> &weights,
+        int numSamples,
+        const Type *inputs,
+        int inputStride,
+        Type *outputs,
+        int outputStride,
+        bool activate,
+        bool fastActivation
+        )
+    {
+        return false;
+    }
+
+    static inline bool multiplySparseLayerVector(
+        const SparseMatrix<float> &weights,
+        int numSamples,
+        const float *inputs,
+        int inputStride,
+        float *outputs,
+        int outputStride,
+        bool activate,
+        bool fastActivation
+        )
+    {
+#if NEAT_LAYER_KERNELS_X86
+        switch (getSimdLevel())
+        {
+        case SIMD_LEVEL_AVX512:
+            multiplySparseLayerAVX512(weights,numSamples,inputs,inputStride,outputs,outputStride,activate,fastActivation);
+            return true;
+        case SIMD_LEVEL_AVX2:
+            multiplySparseLayerAVX2(weights,numSamples,inputs,inputStride,outputs,outputStride,activate,fastActivation);
+            return true;
+        case SIMD_LEVEL_SSE2:
+            multiplySparseLayerSSE2(weights,numSamples,inputs,inputStride,outputs,outputStride,activate,fastActivation);
+            return true;
+        default:
+            break;
+        }
+#endif
+
+        return false;
+    }
+
+    template<class Type>
+    static inline bool activateLayerVector(Type *values,int count,bool fastActivation)
+    {
+        return false;
+    }
+
+    static inline bool activateLayerVector(float *values,int count,bool fastActivation)
+    {
+#if NEAT_LAYER_KERNELS_X86
+        if (!fastActivation)
+        {
+            return false;
+        }
+
+        switch (getSimdLevel())
+        {
+        case SIMD_LEVEL_AVX512:
+        case SIMD_LEVEL_AVX2:
+            activateLayerAVX2(values,count);
+            return true;
+        case SIMD_LEVEL_SSE2:
+            activateLayerSSE2(values,count);
+            return true;
+        default:
+            break;
+        }
+#endif
+
+        return false;
+    }
+
+    template<class Type>
+    double getWeightDensity(const PaddedMatrix<Type> &weights)
+    {
+        if (!weights.numRows || !weights.numColumns)
+        {
+            return 0.0;
+        }
+
+        size_t numNonzero=0;
+        for (int row=0;row<weights.numRows;row++)
+        {
+            for (int column=0;column<weights.numColumns;column++)
+            {
+                if (weights(row,column)!=Type(0))
+                {
+                    numNonzero++;
+                }
+            }
+        }
+
+        return double(numNonzero)/(double(weights.numRows)*weights.numColumns);
+    }
+
+    template<class Type>
+    void activateLayer(
+        Type *values,
+        int count,
+        ActivationAccuracy accuracy
+        )
+    {
+        if (activateLayerVector(values,count,accuracy==ACTIVATION_ACCURACY_FAST))
+        {
+            return;
+        }
+
+        applySignedSigmoid(values,count);
+    }
+
+    template<class Type>
+    void multiplyLayer(
+        const PaddedMatrix<Type> &weights,
+        const Type *input,
+        Type *output,
+        bool activate,
+        ActivationAccuracy accuracy
+        )
+    {
+        multiplyLayerBatch(weights,1,input,weights.rowStride,output,weights.paddedRows,activate,accuracy);
+    }
+
+    template<class Type>
+    void multiplyLayerBatch(
+        const PaddedMatrix<Type> &weights,
+        int numSamples,
+        const Type *inputs,
+        int inputStride,
+        Type *outputs,
+        int outputStride,
+        bool activate,
+        ActivationAccuracy accuracy
+        )
+    {
+        if (!weights.paddedRows || numSamples<=0)
+        {
+            return;
+        }
+
+        if (multiplyLayerVector(weights,numSamples,inputs,inputStride,outputs,outputStride,activate,accuracy==ACTIVATION_ACCURACY_FAST))
+        {
+            return;
+        }
+
+        multiplyLayerScalar(weights,numSamples,inputs,inputStride,outputs,outputStride,activate);
+    }
+
+    template<class Type>
+    void multiplySparseLayerBatch(
+        const SparseMatrix<Type> &weights,
+        int numSamples,
+        const Type *inputs,
+        int inputStride,
+        Type *outputs,
+        int outputStride,
+        bool activate,
+        ActivationAccuracy accuracy
+        )
+    {
+        if (!weights.paddedRows || numSamples<=0)
+        {
+            return;
+        }
+
+        if (multiplySparseLayerVector(weights,numSamples,inputs,inputStride,outputs,outputStride,activate,accuracy==ACTIVATION_ACCURACY_FAST))
+        {
+            return;
+        }
+
+        multiplySparseLayerScalar(weights,numSamples,inputs,inputStride,outputs,outputStride,activate);
+    }
+
+    template NEAT_DLL_EXPORT double getWeightDensity<float>(
+        const PaddedMatrix<float> &
+        ); // explicit instantiation
+    template NEAT_DLL_EXPORT double getWeightDensity<double>(
+        const PaddedMatrix<double> &
+        ); // explicit instantiation
+
+    template NEAT_DLL_EXPORT void activateLayer<float>(
+        float *,int,ActivationAccuracy
+        ); // explicit instantiation
+    template NEAT_DLL_EXPORT void activateLayer<double>(
+        double *,int,ActivationAccuracy
+        ); // explicit instantiation
+
+    template NEAT_DLL_EXPORT void multiplyLayer<float>(
+        const PaddedMatrix<float> &,const float *,float *,bool,ActivationAccuracy
+        ); // explicit instantiation
+    template NEAT_DLL_EXPORT void multiplyLayer<double>(
+        const PaddedMatrix<double> &,const double *,double *,bool,ActivationAccuracy
+        ); // explicit instantiation
+
+    template NEAT_DLL_EXPORT void multiplyLayerBatch<float>(
+        const PaddedMatrix<float> &,int,const float *,int,float *,int,bool,ActivationAccuracy
+        ); // explicit instantiation
+    template NEAT_DLL_EXPORT void multiplyLayerBatch<double>(
+        const PaddedMatrix<double> &,int,const double *,int,double *,int,bool,ActivationAccuracy
+        ); // explicit instantiation
+
+    template NEAT_DLL_EXPORT void multiplySparseLayerBatch<float>(
+        const SparseMatrix<float> &,int,const float *,int,float *,int,bool,ActivationAccuracy
+        ); // explicit instantiation
+    template NEAT_DLL_EXPORT void multiplySparseLayerBatch<double>(
+        const SparseMatrix<double> &,int,const double *,int,double *,int,bool,ActivationAccuracy
+        ); // explicit instantiation
+}
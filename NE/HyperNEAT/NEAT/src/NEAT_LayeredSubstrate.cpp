@@ -3,9 +3,17 @@
 #include "NEAT_LayeredSubstrate.h"
 
 #include "NEAT_GeneticIndividual.h"
+#include "NEAT_GeneticLinkGene.h"
+
+#include "NEAT_SubstrateCache.h"
+
+#include "NEAT_Signature.h"
 
 #include "Board.h"
 
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+
 #define LAYERED_SUBSTRATE_DEBUG (0)
 
 #define DEBUG_USE_DELTAS_ON_LONG_RANGE (1)
@@ -16,26 +24,486 @@
 
 namespace NEAT
 {
+/**
+ * A layer pair whose weights come from a CPPN output.  slot is the output's
+ * position in its LayerPairGroup.
+ */
+class LayerPairOutput
+{
+ public:
+  int z1,z2;
+  int group,slot;
+};
+
+/**
+ * The CPPN queries made for a LayerPairGroup: the source and target node of
+ * every query, and each of the group's outputs for every query
+ */
 template<class NetworkDataType>
-class LinkWeightPair
+class LayerPairQueries
+{
+ public:
+  vector<JGTL::Vector2<int> > sources;
+  vector<JGTL::Vector2<int> > targets;
+  vector<vector<NetworkDataType> > outputs;
+
+  void clear(int numOutputs)
+  {
+    sources.clear();
+    targets.clear();
+    outputs.resize(numOutputs);
+    for (int a=0;a<numOutputs;a++)
+    {
+      outputs[a].clear();
+    }
+  }
+
+  void append(const LayerPairQueries &other)
+  {
+    sources.insert(sources.end(),other.sources.begin(),other.sources.end());
+    targets.insert(targets.end(),other.targets.begin(),other.targets.end());
+    for (int a=0;a<(int)outputs.size();a++)
+    {
+      outputs[a].insert(outputs[a].end(),other.outputs[a].begin(),other.outputs[a].end());
+    }
+  }
+};
+
+/**
+ * The layer pairs that share source and target layer sizes, and so share
+ * their CPPN inputs
+ */
+template<class NetworkDataType>
+class LayerPairGroup
+{
+ public:
+  JGTL::Vector2<int> fromSize,fromValidSize,toSize,toValidSize;
+  bool fromFirstLayer;
+
+  /**
+   * The CPPN coordinates of the source and target layers' columns and rows,
+   * from LayeredSubstrate's coordinate tables
+   */
+  const NetworkDataType *fromXCoordinates,*fromYCoordinates;
+  const NetworkDataType *toXCoordinates,*toYCoordinates;
+
+  vector<int> outputIndices;
+  LayerPairQueries<NetworkDataType> queries;
+};
+
+/**
+ * A square of target nodes in the adaptive substrate's quadtree.  The
+ * square may reach past the edge of the connection window, but only the
+ * nodes inside the window are queried.
+ */
+class QuadTreeCell
 {
  public:
-  JGTL::Vector3<int> fromPos;
-  NetworkDataType weight;
+  int x,y,size,depth;
 
-  LinkWeightPair(
-      JGTL::Vector3<int> _fromPos,
-      NetworkDataType _weight
-      )
+  QuadTreeCell()
+  {}
+
+  QuadTreeCell(int _x,int _y,int _size,int _depth)
       :
-      fromPos(_fromPos),
-      weight(_weight)
+      x(_x),
+      y(_y),
+      size(_size),
+      depth(_depth)
+  {}
+};
+
+/**
+ * Runs the CPPN queries for one share of the source nodes of every group.
+ * A group's valid source nodes are numbered row by row and split into
+ * numShares contiguous ranges, so putting the shares' queries back together
+ * in order gives exactly the queries of a single pass.
+ */
+template<class NetworkDataType>
+class LayerPairQueryTask
+{
+ public:
+  enum
   {
+    //X1,Y1,X2,Y2,DeltaX,DeltaY,Bias
+    INPUT_COUNT=7
+  };
+
+  FastNetwork<NetworkDataType> *cppn;
+  const vector<LayerPairGroup<NetworkDataType> > *groups;
+  const vector<int> *inputIndices;
+  int share,numShares;
+  int maxConnectionLength,maxDeltaLength;
+  bool adaptive;
+  int adaptiveInitialDepth;
+  NetworkDataType adaptiveVarianceThreshold;
+
+  vector<LayerPairQueries<NetworkDataType> > queries;
+
+  /**
+   * error holds the message of an exception thrown on a worker thread, so
+   * it can be rethrown once the threads are joined
+   */
+  string error;
+
+  vector<NetworkDataType> batchInputs[INPUT_COUNT];
+  vector<NetworkDataType*> outputColumns;
+
+  /**
+   * The quadtree levels and CPPN samples of the adaptive substrate
+   */
+  vector<QuadTreeCell> cells,nextCells;
+  vector<int> cellSamples;
+  LayerPairQueries<NetworkDataType> samples;
+
+  void run();
+
+  /**
+   * addQuery: Adds the query from (x1,y1) to (x2,y2) to queries, and its
+   * CPPN inputs to the batch
+   */
+  void addQuery(
+      const LayerPairGroup<NetworkDataType> &group,
+      LayerPairQueries<NetworkDataType> &queries,
+      int x1,int y1,int x2,int y2
+      );
+
+  /**
+   * evaluateQueries: Evaluates the batch, which holds the inputs of the
+   * queries from firstQuery on
+   */
+  void evaluateQueries(
+      const LayerPairGroup<NetworkDataType> &group,
+      LayerPairQueries<NetworkDataType> &queries,
+      int firstQuery
+      );
+
+  /**
+   * addAdaptiveQueries: Subdivides the window of targets of (x1,y1) with
+   * a quadtree and adds the queries of its leaves
+   */
+  void addAdaptiveQueries(
+      const LayerPairGroup<NetworkDataType> &group,
+      LayerPairQueries<NetworkDataType> &queries,
+      int x1,int y1,
+      const JGTL::Vector2<int> &windowStart,
+      const JGTL::Vector2<int> &windowEnd
+      );
+
+  void runInThread()
+  {
+    try
+    {
+      run();
+    }
+    catch(const std::exception &e)
+    {
+      error = e.what();
+    }
+    catch(...)
+    {
+      error = "Unknown exception while populating substrate";
+    }
   }
 };
 
+template<class NetworkDataType>
+void LayerPairQueryTask<NetworkDataType>::run()
+{
+  error.clear();
+  queries.resize(groups->size());
+
+  for (int g=0;g<(int)groups->size();g++)
+  {
+    const LayerPairGroup<NetworkDataType> &group = (*groups)[g];
+    LayerPairQueries<NetworkDataType> &groupQueries = queries[g];
+    int numOutputs = int(group.outputIndices.size());
+
+    groupQueries.clear(numOutputs);
+
+    JGTL::Vector2<int> validInputStart = (group.fromSize - group.fromValidSize)/2;
+
+    JGTL::Vector2<int> validOutputStart = (group.toSize - group.toValidSize)/2;
+    JGTL::Vector2<int> validOutputEnd = ((group.toSize - group.toValidSize)/2) + group.toValidSize;
+
+    if (group.fromValidSize.x<=0 || group.fromValidSize.y<=0)
+    {
+      continue;
+    }
+
+    int numSources = group.fromValidSize.x*group.fromValidSize.y;
+    int firstSource = int((long long)(numSources)*share/numShares);
+    int lastSource = int((long long)(numSources)*(share+1)/numShares);
+
+    for (int source=firstSource;source<lastSource;source++)
+    {
+      int x1 = validInputStart.x + source%group.fromValidSize.x;
+      int y1 = validInputStart.y + source/group.fromValidSize.x;
+
+      //Only the targets within maxConnectionLength of the source in both
+      //directions are connected, so only that window is walked
+      JGTL::Vector2<int> windowStart(
+          max(validOutputStart.x,x1-maxConnectionLength),
+          max(validOutputStart.y,y1-maxConnectionLength)
+          );
+      JGTL::Vector2<int> windowEnd(
+          min(validOutputEnd.x,x1+maxConnectionLength+1),
+          min(validOutputEnd.y,y1+maxConnectionLength+1)
+          );
+
+      if (adaptive)
+      {
+        addAdaptiveQueries(group,groupQueries,x1,y1,windowStart,windowEnd);
+        continue;
+      }
+
+      //Gather every target of this source node so the CPPN can be
+      //evaluated on all of them in one batch
+      int firstQuery = int(groupQueries.targets.size());
+      for (int a=0;a<INPUT_COUNT;a++)
+      {
+        batchInputs[a].clear();
+      }
+
+      for (int y2=windowStart.y;y2<windowEnd.y;y2++)
+      {
+        for (int x2=windowStart.x;x2<windowEnd.x;x2++)
+        {
+#if DEBUG_NO_LONG_RANGE_LINKS
+          if(group.fromFirstLayer && max(abs(x2-x1),abs(y2-y1))>DEBUG_MAX_DELTA_RANGE)
+          {
+            continue;
+          }
+#endif
+
+          addQuery(group,groupQueries,x1,y1,x2,y2);
+        }
+      }
+
+      evaluateQueries(group,groupQueries,firstQuery);
+    }
+  }
+}
+
+template<class NetworkDataType>
+void LayerPairQueryTask<NetworkDataType>::addQuery(
+    const LayerPairGroup<NetworkDataType> &group,
+    LayerPairQueries<NetworkDataType> &queries,
+    int x1,int y1,int x2,int y2
+    )
+{
+  int chessDistance = max(abs(x1-x2),abs(y1-y2));
+
+  NetworkDataType x1normal = group.fromXCoordinates[x1];
+  NetworkDataType y1normal = group.fromYCoordinates[y1];
+  NetworkDataType x2normal = group.toXCoordinates[x2];
+  NetworkDataType y2normal = group.toYCoordinates[y2];
+
+  queries.sources.push_back(JGTL::Vector2<int>(x1,y1));
+  queries.targets.push_back(JGTL::Vector2<int>(x2,y2));
+  batchInputs[0].push_back(x1normal);
+  batchInputs[1].push_back(y1normal);
+  batchInputs[2].push_back(x2normal);
+  batchInputs[3].push_back(y2normal);
+  if(
+#if DEBUG_USE_DELTAS_ON_LONG_RANGE
+#else
+         max(abs(x2-x1),abs(y2-y1))<=DEBUG_MAX_DELTA_RANGE && 
+#endif
+         chessDistance<=maxDeltaLength
+         )
+  {
+    batchInputs[4].push_back(x2normal-x1normal);
+    batchInputs[5].push_back(y2normal-y1normal);
+  }
+  else
+  {
+    batchInputs[4].push_back(0);
+    batchInputs[5].push_back(0);
+  }
+  batchInputs[6].push_back((NetworkDataType)0.3);
+}
+
+template<class NetworkDataType>
+void LayerPairQueryTask<NetworkDataType>::evaluateQueries(
+    const LayerPairGroup<NetworkDataType> &group,
+    LayerPairQueries<NetworkDataType> &queries,
+    int firstQuery
+    )
+{
+  int numOutputs = int(group.outputIndices.size());
+  int numSamples = int(queries.targets.size())-firstQuery;
+  if(numSamples==0)
+  {
+    return;
+  }
+
+  const NetworkDataType *inputColumns[INPUT_COUNT];
+  for (int a=0;a<INPUT_COUNT;a++)
+  {
+    inputColumns[a] = &batchInputs[a][0];
+  }
+  outputColumns.resize(numOutputs);
+  for (int a=0;a<numOutputs;a++)
+  {
+    queries.outputs[a].resize(firstQuery+numSamples);
+    outputColumns[a] = &queries.outputs[a][firstQuery];
+  }
+
+  cppn->evaluateBatch(numSamples,*inputIndices,inputColumns,group.outputIndices,&outputColumns[0]);
+}
+
+template<class NetworkDataType>
+void LayerPairQueryTask<NetworkDataType>::addAdaptiveQueries(
+    const LayerPairGroup<NetworkDataType> &group,
+    LayerPairQueries<NetworkDataType> &queries,
+    int x1,int y1,
+    const JGTL::Vector2<int> &windowStart,
+    const JGTL::Vector2<int> &windowEnd
+    )
+{
+  int numOutputs = int(group.outputIndices.size());
+
+  if (windowEnd.x<=windowStart.x || windowEnd.y<=windowStart.y)
+  {
+    return;
+  }
+
+  //The root is the smallest power of two square that covers the window
+  int rootSize=1;
+  while (rootSize<windowEnd.x-windowStart.x || rootSize<windowEnd.y-windowStart.y)
+  {
+    rootSize *= 2;
+  }
+
+  cells.clear();
+  cells.push_back(QuadTreeCell(windowStart.x,windowStart.y,rootSize,0));
+
+  while (!cells.empty())
+  {
+    //Sample the center of every child of every cell on this level in one
+    //batch.  A cell of size 1 is its own only child.
+    samples.clear(numOutputs);
+    cellSamples.resize(cells.size()+1);
+    for (int a=0;a<INPUT_COUNT;a++)
+    {
+      batchInputs[a].clear();
+    }
+
+    for (int c=0;c<(int)cells.size();c++)
+    {
+      const QuadTreeCell &cell = cells[c];
+      int childSize = max(1,cell.size/2);
+      int childCount = (cell.size>1) ? 2 : 1;
+
+      cellSamples[c] = int(samples.targets.size());
+      for (int cy=0;cy<childCount;cy++)
+      {
+        for (int cx=0;cx<childCount;cx++)
+        {
+          int childX = cell.x + cx*childSize;
+          int childY = cell.y + cy*childSize;
+          if (childX>=windowEnd.x || childY>=windowEnd.y)
+          {
+            continue;
+          }
+
+          //Children that reach past the window are sampled at the center
+          //of the part inside it
+          int x2 = (childX + min(childX+childSize,windowEnd.x) - 1)/2;
+          int y2 = (childY + min(childY+childSize,windowEnd.y) - 1)/2;
+
+          addQuery(group,samples,x1,y1,x2,y2);
+        }
+      }
+    }
+    cellSamples[cells.size()] = int(samples.targets.size());
+
+    evaluateQueries(group,samples,0);
+
+    //Split the cells whose children disagree, and express the children of
+    //the rest
+    nextCells.clear();
+    for (int c=0;c<(int)cells.size();c++)
+    {
+      const QuadTreeCell &cell = cells[c];
+      int firstSample = cellSamples[c];
+      int lastSample = cellSamples[c+1];
+      int childSize = cell.size/2;
+
+      bool split = false;
+      if (childSize>1)
+      {
+        if (cell.depth<adaptiveInitialDepth)
+        {
+          split = true;
+        }
+        for (int a=0;!split && a<numOutputs;a++)
+        {
+          const vector<NetworkDataType> &outputs = samples.outputs[a];
+
+          NetworkDataType mean=0;
+          for (int b=firstSample;b<lastSample;b++)
+          {
+            mean += outputs[b];
+          }
+          mean /= (lastSample-firstSample);
+
+          NetworkDataType variance=0;
+          for (int b=firstSample;b<lastSample;b++)
+          {
+            variance += (outputs[b]-mean)*(outputs[b]-mean);
+          }
+          variance /= (lastSample-firstSample);
+
+          if (variance>adaptiveVarianceThreshold)
+          {
+            split = true;
+          }
+        }
+      }
+
+      if (split)
+      {
+        for (int cy=0;cy<2;cy++)
+        {
+          for (int cx=0;cx<2;cx++)
+          {
+            int childX = cell.x + cx*childSize;
+            int childY = cell.y + cy*childSize;
+            if (childX<windowEnd.x && childY<windowEnd.y)
+            {
+              nextCells.push_back(QuadTreeCell(childX,childY,childSize,cell.depth+1));
+            }
+          }
+        }
+        continue;
+      }
+
+      //Either the children agree or they are single nodes, so their
+      //samples become links
+      for (int b=firstSample;b<lastSample;b++)
+      {
+        queries.sources.push_back(samples.sources[b]);
+        queries.targets.push_back(samples.targets[b]);
+        for (int a=0;a<numOutputs;a++)
+        {
+          queries.outputs[a].push_back(samples.outputs[a][b]);
+        }
+      }
+    }
+
+    cells.swap(nextCells);
+  }
+}
+
 template< class NetworkDataType >
 LayeredSubstrate<NetworkDataType>::LayeredSubstrate()
+    :
+    numThreads(1),
+    adaptiveSubstrate(false),
+    adaptiveInitialDepth(2),
+    adaptiveVarianceThreshold(0.03)
 {
 }
 
@@ -78,6 +546,35 @@ void LayeredSubstrate<NetworkDataType>::setLayerInfo(LayeredSubstrateInfo layerI
   useOldOutputNames = layerInfo.useOldOutputNames;
   maxDeltaLength = layerInfo.maxDeltaLength;
   maxConnectionLength = layerInfo.maxConnectionLength;
+  numThreads = layerInfo.numThreads;
+  adaptiveSubstrate = layerInfo.adaptiveSubstrate;
+  adaptiveInitialDepth = layerInfo.adaptiveInitialDepth;
+  adaptiveVarianceThreshold = layerInfo.adaptiveVarianceThreshold;
+
+  //Remap the nodes to the [-1,1] domain.  The tables have an extra entry so
+  //they are never empty.
+  layerXCoordinates.resize(layerSizes.size());
+  layerYCoordinates.resize(layerSizes.size());
+  for(int z=0;z<int(layerSizes.size());z++)
+  {
+    layerXCoordinates[z].assign(max(layerSizes[z].x,0)+1,NetworkDataType(0.0f));
+    for(int x=0;x<layerSizes[z].x;x++)
+    {
+      if (layerSizes[z].x>1)
+      {
+        layerXCoordinates[z][x] = -1.0f + (NetworkDataType(x)/(layerSizes[z].x-1))*2.0f;
+      }
+    }
+
+    layerYCoordinates[z].assign(max(layerSizes[z].y,0)+1,NetworkDataType(0.0f));
+    for(int y=0;y<layerSizes[z].y;y++)
+    {
+      if (layerSizes[z].y>1)
+      {
+        layerYCoordinates[z][y] = -1.0f + (NetworkDataType(y)/(layerSizes[z].y-1))*2.0f;
+      }
+    }
+  }
 
   /*
     for(int a=0;a<int(layerSizes.size());a++)
@@ -109,7 +606,126 @@ void LayeredSubstrate<NetworkDataType>::populateSubstrate(
 {
   nameLookup.clear();
 
-  NEAT::FastNetwork<NetworkDataType> cppn = individual->spawnFastPhenotypeStack<NetworkDataType>();
+#if !LAYERED_SUBSTRATE_ENABLE_BIASES && !defined(USE_GPU)
+  if(NEAT::Globals::getSingleton()->getSubstrateCacheSize()>0)
+  {
+    SubstrateCache<NetworkDataType> *cache = SubstrateCache<NetworkDataType>::getSingleton();
+
+    string signature = getSubstrateSignature(individual);
+    if(cache->find(signature,network))
+    {
+      return;
+    }
+
+    buildSubstrate(individual);
+
+    cache->insert(signature,network);
+    return;
+  }
+#endif
+
+  buildSubstrate(individual);
+}
+
+template< class NetworkDataType >
+string LayeredSubstrate<NetworkDataType>::getSubstrateSignature(
+    shared_ptr<NEAT::GeneticIndividual> individual
+    )
+{
+  NEAT::Globals *globals = NEAT::Globals::getSingleton();
+
+  //Everything that goes into the substrate weights: the activation
+  //settings the CPPN runs with, the substrate layout and the CPPN genes.
+  //numThreads is left out since it doesn't change the result.
+  string signature;
+  appendBytes(signature,int(sizeof(NetworkDataType)));
+  appendBytes(signature,globals->hasSignedActivation());
+  appendBytes(signature,globals->isUsingTanhSigmoid());
+  appendBytes(signature,globals->getExtraActivationUpdates());
+  appendBytes(signature,int(globals->getActivationAccuracy()));
+
+  appendBytes(signature,int(layerNames.size()));
+  for(int a=0;a<int(layerNames.size());a++)
+  {
+    appendString(signature,layerNames[a]);
+    appendBytes(signature,layerSizes[a].x);
+    appendBytes(signature,layerSizes[a].y);
+    appendBytes(signature,layerValidSizes[a].x);
+    appendBytes(signature,layerValidSizes[a].y);
+    appendBytes(signature,layerIsInput[a]);
+  }
+
+  appendBytes(signature,int(layerAdjacencyList.size()));
+  for(int a=0;a<int(layerAdjacencyList.size());a++)
+  {
+    appendBytes(signature,layerAdjacencyList[a].x);
+    appendBytes(signature,layerAdjacencyList[a].y);
+  }
+
+  appendBytes(signature,normalize);
+  appendBytes(signature,useOldOutputNames);
+  appendBytes(signature,maxDeltaLength);
+  appendBytes(signature,maxConnectionLength);
+  appendBytes(signature,adaptiveSubstrate);
+  if(adaptiveSubstrate)
+  {
+    appendBytes(signature,adaptiveInitialDepth);
+    appendBytes(signature,adaptiveVarianceThreshold);
+  }
+
+  appendBytes(signature,individual->getNodesCount());
+  for(int a=0;a<individual->getNodesCount();a++)
+  {
+    const GeneticNodeGene *nodeGene = individual->getNode(a);
+
+    appendBytes(signature,nodeGene->getID());
+    appendBytes(signature,nodeGene->isEnabled());
+    appendBytes(signature,int(nodeGene->getActivationFunction()));
+    appendString(signature,nodeGene->getType());
+    appendString(signature,nodeGene->getName());
+  }
+
+  appendBytes(signature,individual->getLinksCount());
+  for(int a=0;a<individual->getLinksCount();a++)
+  {
+    const GeneticLinkGene *linkGene = individual->getLink(a);
+
+    appendBytes(signature,linkGene->getID());
+    appendBytes(signature,linkGene->isEnabled());
+    appendBytes(signature,linkGene->getFromNodeID());
+    appendBytes(signature,linkGene->getToNodeID());
+    appendBytes(signature,linkGene->getWeight());
+  }
+
+  return signature;
+}
+
+template< class NetworkDataType >
+void LayeredSubstrate<NetworkDataType>::buildSubstrate(
+    shared_ptr<NEAT::GeneticIndividual> individual
+    )
+{
+  individual->rebindFastPhenotype(cppn);
+
+  //Resolve the CPPN inputs once so the inner loop doesn't do name lookups
+  int x1Index = cppn.getNodeIndex("X1");
+  int y1Index = cppn.getNodeIndex("Y1");
+  int x2Index = cppn.getNodeIndex("X2");
+  int y2Index = cppn.getNodeIndex("Y2");
+  int deltaXIndex = cppn.getNodeIndex("DeltaX");
+  int deltaYIndex = cppn.getNodeIndex("DeltaY");
+  int biasIndex = cppn.getNodeIndex("Bias");
+
+  //One batch column per CPPN input, in the order X1,Y1,X2,Y2,DeltaX,DeltaY,Bias
+  vector<int> batchInputIndices;
+  batchInputIndices.push_back(x1Index);
+  batchInputIndices.push_back(y1Index);
+  batchInputIndices.push_back(x2Index);
+  batchInputIndices.push_back(y2Index);
+  batchInputIndices.push_back(deltaXIndex);
+  batchInputIndices.push_back(deltaYIndex);
+  batchInputIndices.push_back(biasIndex);
+
 
   int linkCounter=0;
 
@@ -119,8 +735,6 @@ void LayeredSubstrate<NetworkDataType>::populateSubstrate(
 
   int connectionCount=0;
 
-  map<JGTL::Vector3<int>, vector<LinkWeightPair<NetworkDataType> > > allIncomingLinks;
-
   vector<NetworkLayer<NetworkDataType> > layers;
   for(int a=0;a<int(layerNames.size());a++)
   {
@@ -132,9 +746,17 @@ void LayeredSubstrate<NetworkDataType>::populateSubstrate(
         fromLayers.push_back(layerAdjacencyList[b].x);
       }
     }
-    layers.push_back(NetworkLayer<NetworkDataType>(layerNames[a],layerValidSizes[a].x*layerValidSizes[a].y,layerValidSizes[a].x,fromLayers,layerValidSizes));
+    //The layers hold the padding too, since links and setValue() address
+    //nodes by their place in the whole layer
+    layers.push_back(NetworkLayer<NetworkDataType>(layerNames[a],layerSizes[a].x*layerSizes[a].y,layerSizes[a].x,fromLayers,layerSizes));
   }
 
+  //Collect the layer pairs that have a CPPN output, and group the pairs
+  //whose layers have the same sizes.  They see the same CPPN inputs, so
+  //each group is evaluated once and all of its outputs are read at once.
+  vector<LayerPairOutput> pairOutputs;
+  vector<LayerPairGroup<NetworkDataType> > groups;
+
   for (int z1=0;z1<(int)layerSizes.size();z1++)
   {
     for (int z2=0;z2<(int)layerSizes.size();z2++)
@@ -152,274 +774,303 @@ void LayeredSubstrate<NetworkDataType>::populateSubstrate(
         outputNodeName = string("Output_")+layerNames[z1]+string("_")+layerNames[z2];
       }
 
-      if(cppn.hasNode(outputNodeName)==false)
+      int outputIndex = cppn.getNodeIndex(outputNodeName);
+      if(outputIndex==-1)
       {
         continue;
       }
 
-      JGTL::Vector2<int> validInputStart = (layerSizes[z1] - layerValidSizes[z1])/2;
-      JGTL::Vector2<int> validInputEnd = ((layerSizes[z1] - layerValidSizes[z1])/2) + layerValidSizes[z1];
+      bool fromFirstLayer = DEBUG_NO_LONG_RANGE_LINKS && z1==0;
+
+      int group=0;
+      while(
+          group<(int)groups.size() &&
+          !(
+              groups[group].fromSize==layerSizes[z1] &&
+              groups[group].fromValidSize==layerValidSizes[z1] &&
+              groups[group].toSize==layerSizes[z2] &&
+              groups[group].toValidSize==layerValidSizes[z2] &&
+              groups[group].fromFirstLayer==fromFirstLayer
+              )
+          )
+      {
+        group++;
+      }
+      if(group==(int)groups.size())
+      {
+        groups.push_back(LayerPairGroup<NetworkDataType>());
+        groups[group].fromSize = layerSizes[z1];
+        groups[group].fromValidSize = layerValidSizes[z1];
+        groups[group].toSize = layerSizes[z2];
+        groups[group].toValidSize = layerValidSizes[z2];
+        groups[group].fromFirstLayer = fromFirstLayer;
+        groups[group].fromXCoordinates = &layerXCoordinates[z1][0];
+        groups[group].fromYCoordinates = &layerYCoordinates[z1][0];
+        groups[group].toXCoordinates = &layerXCoordinates[z2][0];
+        groups[group].toYCoordinates = &layerYCoordinates[z2][0];
+      }
 
-      JGTL::Vector2<int> validOutputStart = (layerSizes[z2] - layerValidSizes[z2])/2;
-      JGTL::Vector2<int> validOutputEnd = ((layerSizes[z2] - layerValidSizes[z2])/2) + layerValidSizes[z2];
+      LayerPairOutput pairOutput;
+      pairOutput.z1 = z1;
+      pairOutput.z2 = z2;
+      pairOutput.group = group;
+      pairOutput.slot = int(groups[group].outputIndices.size());
+      pairOutputs.push_back(pairOutput);
 
-      for (int y1=validInputStart.y;y1<validInputEnd.y;y1++)
+      groups[group].outputIndices.push_back(outputIndex);
+    }
+  }
+
+  //The source nodes are split between numThreads tasks.  The calling
+  //thread runs the first with the CPPN itself, and every other task gets a
+  //thread and its own copy of the CPPN.
+  int numTasks = max(1,numThreads);
+  vector<LayerPairQueryTask<NetworkDataType> > tasks(numTasks);
+  if (int(threadCPPNs.size())<numTasks-1)
+  {
+    threadCPPNs.resize(numTasks-1);
+  }
+  for (int t=0;t<numTasks;t++)
+  {
+    tasks[t].cppn = t ? &threadCPPNs[t-1] : &cppn;
+    tasks[t].groups = &groups;
+    tasks[t].inputIndices = &batchInputIndices;
+    tasks[t].share = t;
+    tasks[t].numShares = numTasks;
+    tasks[t].maxConnectionLength = maxConnectionLength;
+    tasks[t].maxDeltaLength = maxDeltaLength;
+    tasks[t].adaptive = adaptiveSubstrate;
+    tasks[t].adaptiveInitialDepth = adaptiveInitialDepth;
+    tasks[t].adaptiveVarianceThreshold = NetworkDataType(adaptiveVarianceThreshold);
+  }
+
+  if (numTasks==1)
+  {
+    tasks[0].run();
+  }
+  else
+  {
+    vector<boost::thread*> threads(numTasks-1);
+    for (int t=1;t<numTasks;t++)
+    {
+      threadCPPNs[t-1] = cppn;
+      threads[t-1] =
+        new boost::thread(
+            boost::bind(
+                &LayerPairQueryTask<NetworkDataType>::runInThread,
+                &tasks[t]
+                )
+            );
+    }
+
+    tasks[0].runInThread();
+
+    for (int t=1;t<numTasks;t++)
+    {
+      threads[t-1]->join();
+      delete threads[t-1];
+    }
+
+    for (int t=0;t<numTasks;t++)
+    {
+      if (tasks[t].error.length())
       {
-        for (int x1=validInputStart.x;x1<validInputEnd.x;x1++)
-        {
-          for (int y2=validOutputStart.y;y2<validOutputEnd.y;y2++)
-          {
-            for (int x2=validOutputStart.x;x2<validOutputEnd.x;x2++)
-            {
-              int chessDistance = max(abs(x1-x2),abs(y1-y2));
+        throw CREATE_LOCATEDEXCEPTION_INFO(tasks[t].error);
+      }
+    }
+  }
 
-              if(chessDistance>maxConnectionLength)
-              {
-                continue;
-              }
+  //Put each group's queries back together in source node order
+  for (int g=0;g<(int)groups.size();g++)
+  {
+    groups[g].queries.outputs.swap(tasks[0].queries[g].outputs);
+    groups[g].queries.sources.swap(tasks[0].queries[g].sources);
+    groups[g].queries.targets.swap(tasks[0].queries[g].targets);
+    for (int t=1;t<numTasks;t++)
+    {
+      groups[g].queries.append(tasks[t].queries[g]);
+    }
+  }
 
+  //Group the links by destination node.  Each pair's outputs are turned
+  //into weights in place and counted, and then the links are placed in
+  //layer pair order, so within a node they are in query order.
+  layerNodeOffsets.resize(layerSizes.size()+1);
+  layerNodeOffsets[0]=0;
+  for (int z=0;z<(int)layerSizes.size();z++)
+  {
+    layerNodeOffsets[z+1] = layerNodeOffsets[z] + layerSizes[z].x*layerSizes[z].y;
+  }
+  int numNodes = layerNodeOffsets[layerSizes.size()];
 
+  incomingLinkStart.assign(numNodes+1,0);
+  for (int a=0;a<(int)pairOutputs.size();a++)
+  {
+    int z2 = pairOutputs[a].z2;
+    LayerPairQueries<NetworkDataType> &queries = groups[pairOutputs[a].group].queries;
+    vector<NetworkDataType> &groupOutputs = queries.outputs[pairOutputs[a].slot];
 
-#if DEBUG_NO_LONG_RANGE_LINKS
-              if(z1==0 && max(abs(x2-x1),abs(y2-y1))>DEBUG_MAX_DELTA_RANGE)
-              {
-                continue;
-              }
-#endif
+    for (int b=0;b<(int)queries.targets.size();b++)
+    {
+      NetworkDataType output = convertOutputToWeight(groupOutputs[b]);
+      groupOutputs[b] = output;
 
-              /*Remap the nodes to the [-1,1] domain*/
-              NetworkDataType x1normal,y1normal,x2normal,y2normal;
-
-              if (layerSizes[z1].x>1)
-              {
-                x1normal = -1.0f + (NetworkDataType(x1)/(layerSizes[z1].x-1))*2.0f;
-              }
-              else
-              {
-                x1normal = 0.0f;
-              }
-
-              if (layerSizes[z1].y>1)
-              {
-                y1normal = -1.0f + (NetworkDataType(y1)/(layerSizes[z1].y-1))*2.0f;
-              }
-              else
-              {
-                y1normal = 0.0f;
-              }
-
-              if (layerSizes[z2].x>1)
-              {
-                x2normal = -1.0f + (NetworkDataType(x2)/(layerSizes[z2].x-1))*2.0f;
-              }
-              else
-              {
-                x2normal = 0.0f;
-              }
-
-              if (layerSizes[z2].y>1)
-              {
-                y2normal = -1.0f + (NetworkDataType(y2)/(layerSizes[z2].y-1))*2.0f;
-              }
-              else
-              {
-                y2normal = 0.0f;
-              }
-
-              cppn.reinitialize();
-              if (cppn.hasNode("X1"))
-              {
-                cppn.setValue("X1",x1normal);
-                cppn.setValue("Y1",y1normal);
-              }
-              if (cppn.hasNode("X2"))
-              {
-                cppn.setValue("X2",x2normal);
-                cppn.setValue("Y2",y2normal);
-              }
-              if(cppn.hasNode("DeltaX"))
-              {
-                if(
-#if DEBUG_USE_DELTAS_ON_LONG_RANGE
-#else
-                       max(abs(x2-x1),abs(y2-y1))<=DEBUG_MAX_DELTA_RANGE && 
-#endif
-                       chessDistance<=maxDeltaLength
-                       )
-                {
-                  //cout << x1 << ',' << x2 << ',' << y1 << ',' << y2 << endl;
-                  //cout << x1normal << ',' << x2normal << ',' << y1normal << ',' << y2normal << endl;
-                  //cout << "DeltaX:" << (x2normal-x1normal)
-                  //<< ", DeltaY: " << (y2normal-y1normal)
-                  //<< endl;
-                  cppn.setValue("DeltaX",x2normal-x1normal);
-                  cppn.setValue("DeltaY",y2normal-y1normal);
-                }
-                else
-                {
-                  cppn.setValue("DeltaX",0);
-                  cppn.setValue("DeltaY",0);
-                }
-              }
-
-              if(cppn.hasNode("Bias"))
-              {
-                cppn.setValue("Bias",(NetworkDataType)0.3);
-              }
-
-              cppn.update();
-
-              NetworkDataType output;
-
-              output = cppn.getValue(outputNodeName);
-
-              output = convertOutputToWeight(output);
-
-              JGTL::Vector3<int> inputNode(x1,y1,z1);
-              JGTL::Vector3<int> outputNode(x2,y2,z2);
-              if(allIncomingLinks.find(outputNode)==allIncomingLinks.end())
-              {
-                allIncomingLinks[outputNode] = vector<LinkWeightPair<NetworkDataType> >();
-              }
-
-              vector<LinkWeightPair<NetworkDataType> > &incomingLinks = allIncomingLinks[outputNode];
-              if(fabs(output)>0.0)
-              {
-                incomingLinks.push_back(LinkWeightPair<NetworkDataType> (inputNode,output));
-              }
-
-              linkCounter++;
+      if(fabs(output)>0.0)
+      {
+        int toNode = layerNodeOffsets[z2] + queries.targets[b].y*layerSizes[z2].x + queries.targets[b].x;
+        incomingLinkStart[toNode+1]++;
+      }
+
+      linkCounter++;
+    }
+  }
+  for (int a=0;a<numNodes;a++)
+  {
+    incomingLinkStart[a+1] += incomingLinkStart[a];
+  }
+
+  incomingLinkSources.resize(incomingLinkStart[numNodes]);
+  incomingLinkWeights.resize(incomingLinkStart[numNodes]);
+
+  //Each row start is used as its fill position, which leaves it at the
+  //start of the next row, so the starts are shifted back afterwards
+  for (int a=0;a<(int)pairOutputs.size();a++)
+  {
+    int z1 = pairOutputs[a].z1;
+    int z2 = pairOutputs[a].z2;
+    const LayerPairQueries<NetworkDataType> &queries = groups[pairOutputs[a].group].queries;
+    const vector<NetworkDataType> &groupOutputs = queries.outputs[pairOutputs[a].slot];
+
+    for (int b=0;b<(int)queries.targets.size();b++)
+    {
+      if(fabs(groupOutputs[b])>0.0)
+      {
+        int toNode = layerNodeOffsets[z2] + queries.targets[b].y*layerSizes[z2].x + queries.targets[b].x;
+        int entry = incomingLinkStart[toNode]++;
+        incomingLinkSources[entry] = Node(queries.sources[b].x,queries.sources[b].y,z1);
+        incomingLinkWeights[entry] = groupOutputs[b];
+      }
 
 #if LAYERED_SUBSTRATE_ENABLE_BIASES
-              throw CREATE_LOCATEDEXCEPTION_INFO("NOT SUPPORTED YET");
-              if (x1==0&&y1==0&&z1==0)
-              {
-                NetworkDataType nodeBias;
-
-                if (z2==1)
-                {
-                  nodeBias = network.getValue("Bias_b");
-
-                  nodeBias = convertOutputToWeight(nodeBias);
-
-                  /*{
-                    cout << "Setting bias for "
-                    << nameLookup[Node(x2-layerSizes[z2].x/2,y2-layerSizes[z2].y/2,1)]
-                    << endl;
-                    cout << "Bias: " << nodeBias << endl;
-                    CREATE_PAUSE("");
-                    }*/
-
-                  substrate.setBias(
-                      *nameLookup.getData(Node(x2,y2,z2)),
-                      nodeBias
-                      );
-                }
-                else if (z2==2)
-                {
-                  nodeBias = network.getValue("Bias_c");
-
-                  nodeBias = convertOutputToWeight(nodeBias);
-
-                  /*{
-                    cout << "Setting bias for "
-                    << nameLookup[Node(x2-layerSizes[z2].x/2,y2-layerSizes[z2].y/2,2)]
-                    << endl;
-                    cout << "Bias: " << nodeBias << endl;
-                    CREATE_PAUSE("");
-                    }*/
-
-                  substrate.setBias(
-                      *nameLookup.getData(Node(x2,y2,z2)),
-                      nodeBias
-                      );
-                }
-                else
-                {
-                  throw CREATE_LOCATEDEXCEPTION_INFO("wtf");
-                }
-              }
-#endif
-            }
-          }
+      throw CREATE_LOCATEDEXCEPTION_INFO("NOT SUPPORTED YET");
+      int x2 = queries.targets[b].x;
+      int y2 = queries.targets[b].y;
+      if (queries.sources[b].x==0&&queries.sources[b].y==0&&z1==0)
+      {
+        NetworkDataType nodeBias;
+
+        if (z2==1)
+        {
+          nodeBias = network.getValue("Bias_b");
+
+          nodeBias = convertOutputToWeight(nodeBias);
+
+          /*{
+            cout << "Setting bias for "
+            << nameLookup[Node(x2-layerSizes[z2].x/2,y2-layerSizes[z2].y/2,1)]
+            << endl;
+            cout << "Bias: " << nodeBias << endl;
+            CREATE_PAUSE("");
+            }*/
+
+          substrate.setBias(
+              *nameLookup.getData(Node(x2,y2,z2)),
+              nodeBias
+              );
+        }
+        else if (z2==2)
+        {
+          nodeBias = network.getValue("Bias_c");
+
+          nodeBias = convertOutputToWeight(nodeBias);
+
+          /*{
+            cout << "Setting bias for "
+            << nameLookup[Node(x2-layerSizes[z2].x/2,y2-layerSizes[z2].y/2,2)]
+            << endl;
+            cout << "Bias: " << nodeBias << endl;
+            CREATE_PAUSE("");
+            }*/
+
+          substrate.setBias(
+              *nameLookup.getData(Node(x2,y2,z2)),
+              nodeBias
+              );
+        }
+        else
+        {
+          throw CREATE_LOCATEDEXCEPTION_INFO("wtf");
         }
       }
+#endif
     }
   }
+  for (int a=numNodes;a>0;a--)
+  {
+    incomingLinkStart[a] = incomingLinkStart[a-1];
+  }
+  incomingLinkStart[0]=0;
 
   if(normalize)
   {
     //cout << "NORMALIZING\n";
-    //Normalize (and potentially delete) connections
-    typename map<JGTL::Vector3<int>,  vector< LinkWeightPair<NetworkDataType> > >::iterator it;
-    for(
-            it = allIncomingLinks.begin();
-            it!=allIncomingLinks.end();
-            it++
-            )
-    {
-                
+    //Normalize (and potentially delete) connections.  Deleting moves the
+    //remaining links down, so the rows stay packed.
+    int numKept=0;
+    for (int node=0;node<numNodes;node++)
+    {
+      int rowBegin = incomingLinkStart[node];
+      int rowEnd = incomingLinkStart[node+1];
+      int keptBegin = numKept;
+
       //Normalize
       NetworkDataType sumSq=0;
-      vector<LinkWeightPair<NetworkDataType> > &incomingLinks = it->second;
-      for(int b=0;b<(int)incomingLinks.size();b++)
+      for(int b=rowBegin;b<rowEnd;b++)
       {
-        sumSq += incomingLinks[b].weight*incomingLinks[b].weight;
+        sumSq += incomingLinkWeights[b]*incomingLinkWeights[b];
       }
       NetworkDataType magnitude = sqrt(sumSq);
 
       //Divide by magnitude & delete
-      for(int b=int(incomingLinks.size())-1;b>=0;b--)
+      for(int b=rowBegin;b<rowEnd;b++)
       {
         //Normalize to 3.0
-        incomingLinks[b].weight = incomingLinks[b].weight*3.0f/magnitude;
+        NetworkDataType weight = incomingLinkWeights[b]*3.0f/magnitude;
 
-        if(fabs(incomingLinks[b].weight)<0.05)
+        if(fabs(weight)<0.05)
         {
           //The weight is too small, kill it
-          incomingLinks.erase(incomingLinks.begin()+b);
+          continue;
         }
+
+        incomingLinkSources[numKept] = incomingLinkSources[b];
+        incomingLinkWeights[numKept] = weight;
+        numKept++;
       }
 
       //Renormalize
       sumSq=0;
-      incomingLinks = it->second;
-      for(int b=0;b<(int)incomingLinks.size();b++)
+      for(int b=keptBegin;b<numKept;b++)
       {
-        sumSq += incomingLinks[b].weight*incomingLinks[b].weight;
+        sumSq += incomingLinkWeights[b]*incomingLinkWeights[b];
       }
       magnitude = sqrt(sumSq);
-      for(int b=int(incomingLinks.size())-1;b>=0;b--)
+      for(int b=keptBegin;b<numKept;b++)
       {
         //Normalize to 3.0
-        incomingLinks[b].weight = incomingLinks[b].weight*3.0f/magnitude;
+        incomingLinkWeights[b] = incomingLinkWeights[b]*3.0f/magnitude;
       }
+
+      incomingLinkStart[node] = keptBegin;
     }
+    incomingLinkStart[numNodes] = numKept;
+    incomingLinkSources.resize(numKept);
+    incomingLinkWeights.resize(numKept);
   }
 
 #if 0
   //Create network from connections
-  int numLinks=0;
-  typename map<JGTL::Vector3<int>,  vector< LinkWeightPair<NetworkDataType> > >::iterator it;
-  for(
-          it = allIncomingLinks.begin();
-          it!=allIncomingLinks.end();
-          it++
-          )
-  {
-    vector<LinkWeightPair<NetworkDataType> > &incomingLinks = it->second;
-    for(int b=0;b<(int)incomingLinks.size();b++)
-    {
-      numLinks++;
-    }
-  }
-
-  int numNodes = 0;
-  for(int a=0;a<(int)layerSizes.size();a++)
-  {
-    numNodes += (layerSizes[a].x*layerSizes[a].y);
-    //cout << "LAYER SIZE: " << layerSizes[a] << endl;
-  }
+  int numLinks=int(incomingLinkSources.size());
 
   //cout << "NUM NODES: " << numNodes << endl;
   //cout << "NUM LINKS: " << numLinks << endl;
@@ -465,20 +1116,14 @@ void LayeredSubstrate<NetworkDataType>::populateSubstrate(
   }
 
   int currentLinkIndex=0;
-  for(
-          it = allIncomingLinks.begin();
-          it!=allIncomingLinks.end();
-          it++
-          )
+  for(int node=0;node<numNodes;node++)
   {
-    vector<LinkWeightPair<NetworkDataType> > &incomingLinks = it->second;
-    Node node = it->first;
-    NetworkNode *toNode = &tmpNodes[ nodeToIndex[ node ] ];
-    for(int b=0;b<(int)incomingLinks.size();b++)
+    NetworkNode *toNode = &tmpNodes[ node ];
+    for(int b=incomingLinkStart[node];b<incomingLinkStart[node+1];b++)
     {
-      NetworkNode *fromNode = &tmpNodes[ nodeToIndex[ incomingLinks[b].fromPos ] ];
+      NetworkNode *fromNode = &tmpNodes[ nodeToIndex[ incomingLinkSources[b] ] ];
 
-      tmpLinks[currentLinkIndex] = NetworkLink(fromNode,toNode,true,incomingLinks[b].weight);
+      tmpLinks[currentLinkIndex] = NetworkLink(fromNode,toNode,true,incomingLinkWeights[b]);
       currentLinkIndex++;
     }
   }
@@ -496,33 +1141,65 @@ void LayeredSubstrate<NetworkDataType>::populateSubstrate(
       );
 #endif
 
-  network = NEAT::FastLayeredNetwork<NetworkDataType>(layers);
+  //The weights go into the layers before the network is built, so it
+  //can measure each layer pair's density and pick a dense or sparse layout
+  int node=0;
+  for (int z=0;z<(int)layerSizes.size();z++)
+  {
+    NetworkLayer<NetworkDataType> &toLayer = layers[z];
+
+    for (int y=0;y<layerSizes[z].y;y++)
+    {
+      for (int x=0;x<layerSizes[z].x;x++,node++)
+      {
+        int toNodeArrayIndex = y*toLayer.nodeStride + x;
+
+        for(int b=incomingLinkStart[node];b<incomingLinkStart[node+1];b++)
+        {
+          const Node &fromNode = incomingLinkSources[b];
+
+          int a = int(find(toLayer.fromLayers.begin(),toLayer.fromLayers.end(),fromNode.z)-toLayer.fromLayers.begin());
+          if(a==int(toLayer.fromLayers.size()))
+          {
+            throw CREATE_LOCATEDEXCEPTION_INFO("OOPS");
+          }
+
+          const NetworkLayer<NetworkDataType> &fromLayer = layers[fromNode.z];
+          int numFromNodes = int(fromLayer.nodeValues.size());
+          int fromNodeArrayIndex = fromNode.y*fromLayer.nodeStride + fromNode.x;
+          if(fromNodeArrayIndex>=numFromNodes || toNodeArrayIndex>=int(toLayer.nodeValues.size()))
+          {
+            throw CREATE_LOCATEDEXCEPTION_INFO("OOPS");
+          }
+
+          toLayer.fromWeights[a][toNodeArrayIndex*numFromNodes+fromNodeArrayIndex] = incomingLinkWeights[b];
+        }
+      }
+    }
+  }
+
 #ifdef USE_GPU
   gpuNetwork = NEAT::GPUANN(layers);
-#endif
 
-  typename map<JGTL::Vector3<int>,  vector< LinkWeightPair<NetworkDataType> > >::iterator it;
-  for(
-          it = allIncomingLinks.begin();
-          it!=allIncomingLinks.end();
-          it++
-          )
+  node=0;
+  for (int z=0;z<(int)layerSizes.size();z++)
   {
-    vector<LinkWeightPair<NetworkDataType> > &incomingLinks = it->second;
-    Node toNode = it->first;
-
-    for(int b=0;b<(int)incomingLinks.size();b++)
+    for (int y=0;y<layerSizes[z].y;y++)
     {
-      Node fromNode = incomingLinks[b].fromPos;
-      NetworkDataType weight = incomingLinks[b].weight;
+      for (int x=0;x<layerSizes[z].x;x++,node++)
+      {
+        Node toNode(x,y,z);
 
-      network.setLink(fromNode,toNode,weight);
-#ifdef USE_GPU
-      gpuNetwork.setLink(fromNode,toNode,weight);
-#endif
+        for(int b=incomingLinkStart[node];b<incomingLinkStart[node+1];b++)
+        {
+          gpuNetwork.setLink(incomingLinkSources[b],toNode,incomingLinkWeights[b]);
+        }
+      }
     }
-
   }
+#endif
+
+  network = NEAT::FastLayeredNetwork<NetworkDataType>(layers);
 
 #if 0
   delete[] tmpNodes;
@@ -611,6 +1288,53 @@ void LayeredSubstrate<NetworkDataType>::setValue(const Node &node,NetworkDataTyp
 #endif
 }
 
+template< class NetworkDataType >
+void LayeredSubstrate<NetworkDataType>::setInputValue(const Node &node,NetworkDataType _value)
+{
+#ifdef USE_GPU
+  setValue(node,_value);
+#else
+  JGTL::Vector2<int> validInputStart = (layerSizes[node.z] - layerValidSizes[node.z])/2;
+  network.setInputValue( Node(node.x+validInputStart.x,node.y+validInputStart.y,node.z) ,_value);
+#endif
+}
+
+template< class NetworkDataType >
+LayerView<NetworkDataType> LayeredSubstrate<NetworkDataType>::getInputLayer(int z)
+{
+#ifdef USE_GPU
+  LayerView<NetworkDataType> view = gpuNetwork.getInputLayerValues(z);
+#else
+  LayerView<NetworkDataType> view = network.getInputLayerValues(z);
+#endif
+
+  //Skip to the node that setValue() calls (0,0), and leave out the
+  //padding on every side
+  JGTL::Vector2<int> validInputStart = (layerSizes[z] - layerValidSizes[z])/2;
+  view.data = &view(validInputStart.x,validInputStart.y);
+  view.width = layerValidSizes[z].x;
+  view.height = layerValidSizes[z].y;
+  return view;
+}
+
+template< class NetworkDataType >
+LayerView<const NetworkDataType> LayeredSubstrate<NetworkDataType>::getOutputLayer(int z)
+{
+#ifdef USE_GPU
+  LayerView<const NetworkDataType> view = gpuNetwork.getLayerValues(z);
+#else
+  LayerView<const NetworkDataType> view = network.getLayerValues(z);
+#endif
+
+  //Skip to the node that getValue() calls (0,0), and leave out the
+  //padding on every side
+  JGTL::Vector2<int> validInputStart = (layerSizes[z] - layerValidSizes[z])/2;
+  view.data = &view(validInputStart.x,validInputStart.y);
+  view.width = layerValidSizes[z].x;
+  view.height = layerValidSizes[z].y;
+  return view;
+}
+
 template< class NetworkDataType >
 void LayeredSubstrate<NetworkDataType>::getWeightRGB(float &r,float &g,float &b,const Node &currentNode,const Node &sourceNode)
 {
@@ -0,0 +1,667 @@
+#include "NEAT_Defines.h"
+
+#include "NEAT_NetworkCompiler.h"
+
+#include "NEAT_FastNetwork.h"
+
+#include "NEAT_Globals.h"
+
+#include "NEAT_Signature.h"
+
+#include <iomanip>
+#include <limits>
+
+#include <boost/bind.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define NEAT_HAVE_DLOPEN
+#include <dlfcn.h>
+#include <unistd.h>
+#endif
+
+namespace NEAT
+{
+    extern double signedSigmoidTable[6001];
+    extern double unsignedSigmoidTable[6001];
+
+    /*
+     * The generated activation functions must stay in step with the exact
+     * functors in NEAT_ActivationKernels.cpp.  They are written out in the
+     * same types so the same math overloads get picked.
+     */
+    static const char *activationSource =
+        "static inline Type signedTableSigmoid(Type tmpVal,const double *signedSigmoidTable,const double *)\n"
+        "{\n"
+        "    if (!(tmpVal>=-2.9 && tmpVal<=2.9))\n"
+        "    {\n"
+        "        return (Type)( ((1.0 / (1+exp(-tmpVal))) - 0.5)*2.0 );\n"
+        "    }\n"
+        "    return (Type)signedSigmoidTable[int(tmpVal*1000.0)+3000];\n"
+        "}\n"
+        "static inline Type unsignedTableSigmoid(Type tmpVal,const double *,const double *unsignedSigmoidTable)\n"
+        "{\n"
+        "    if (!(tmpVal>=-2.9 && tmpVal<=2.9))\n"
+        "    {\n"
+        "        return 1 / (1+exp(-tmpVal));\n"
+        "    }\n"
+        "    return (Type)unsignedSigmoidTable[int(tmpVal*1000.0)+3000];\n"
+        "}\n"
+        "static inline Type signedTanhSigmoid(Type tmpVal,const double *,const double *)\n"
+        "{\n"
+        "    return 2 / (1 + exp(-2 * tmpVal)) - 1;\n"
+        "}\n"
+        "static inline Type unsignedTanhSigmoid(Type tmpVal,const double *,const double *)\n"
+        "{\n"
+        "    return (1 + exp(-2 * tmpVal));\n"
+        "}\n"
+        "static inline Type signedSin(Type tmpVal,const double *,const double *)\n"
+        "{\n"
+        "    return sin(tmpVal);\n"
+        "}\n"
+        "static inline Type unsignedSin(Type tmpVal,const double *,const double *)\n"
+        "{\n"
+        "    return (sin(tmpVal)+1)/2;\n"
+        "}\n"
+        "static inline Type signedCos(Type tmpVal,const double *,const double *)\n"
+        "{\n"
+        "    return cos(tmpVal);\n"
+        "}\n"
+        "static inline Type unsignedCos(Type tmpVal,const double *,const double *)\n"
+        "{\n"
+        "    return (cos(tmpVal)+1)/2;\n"
+        "}\n"
+        "static inline Type gaussian(Type tmpVal,const double *,const double *)\n"
+        "{\n"
+        "    return exp(-pow(tmpVal,2));\n"
+        "}\n"
+        "static inline Type square(Type tmpVal,const double *,const double *)\n"
+        "{\n"
+        "    return tmpVal*tmpVal;\n"
+        "}\n"
+        "static inline Type signedAbsRoot(Type tmpVal,const double *,const double *)\n"
+        "{\n"
+        "    Type root = sqrt(fabs(tmpVal));\n"
+        "    return (tmpVal<0.0) ? -root : root;\n"
+        "}\n"
+        "static inline Type unsignedAbsRoot(Type tmpVal,const double *,const double *)\n"
+        "{\n"
+        "    return sqrt(fabs(tmpVal));\n"
+        "}\n"
+        "static inline Type signedLinear(Type tmpVal,const double *,const double *)\n"
+        "{\n"
+        "    return min(max(tmpVal,(Type)-3.0),(Type)3.0) / (Type)3.0;\n"
+        "}\n"
+        "static inline Type unsignedLinear(Type tmpVal,const double *,const double *)\n"
+        "{\n"
+        "    return ((min(max(tmpVal,(Type)-3.0),(Type)3.0) / (Type)3.0) + 1) / (Type)2.0;\n"
+        "}\n"
+        "static inline Type signedOnesCompliment(Type tmpVal,const double *,const double *)\n"
+        "{\n"
+        "    Type tmpVal2 = (Type)min(1.0,max(-1.0,tmpVal/3.0));\n"
+        "    if (tmpVal>-0.1)\n"
+        "    {\n"
+        "        return (Type)1.0-tmpVal2;\n"
+        "    }\n"
+        "    return ((Type)-1.0) - tmpVal;\n"
+        "}\n"
+        "static inline Type unsignedOnesCompliment(Type tmpVal,const double *,const double *)\n"
+        "{\n"
+        "    Type tmpVal2 = (Type)min(1.0,max(0.0,tmpVal/3.0));\n"
+        "    return ((Type)1.0)-tmpVal2;\n"
+        "}\n";
+
+    static const char *getActivationName(ActivationFunction function,bool signedActivation,bool usingTanhSigmoid)
+    {
+        switch (function)
+        {
+        case ACTIVATION_FUNCTION_SIGMOID:
+            if (usingTanhSigmoid)
+                return signedActivation ? "signedTanhSigmoid" : "unsignedTanhSigmoid";
+            else
+                return signedActivation ? "signedTableSigmoid" : "unsignedTableSigmoid";
+        case ACTIVATION_FUNCTION_SIN:
+            return signedActivation ? "signedSin" : "unsignedSin";
+        case ACTIVATION_FUNCTION_COS:
+            return signedActivation ? "signedCos" : "unsignedCos";
+        case ACTIVATION_FUNCTION_GAUSSIAN:
+            return "gaussian";
+        case ACTIVATION_FUNCTION_SQUARE:
+            return "square";
+        case ACTIVATION_FUNCTION_ABS_ROOT:
+            return signedActivation ? "signedAbsRoot" : "unsignedAbsRoot";
+        case ACTIVATION_FUNCTION_LINEAR:
+            return signedActivation ? "signedLinear" : "unsignedLinear";
+        case ACTIVATION_FUNCTION_ONES_COMPLIMENT:
+            return signedActivation ? "signedOnesCompliment" : "unsignedOnesCompliment";
+        default:
+            throw CREATE_LOCATEDEXCEPTION_INFO("Unknown activation function!!!");
+        }
+    }
+
+    static const char *getTypeName(float)
+    {
+        return "float";
+    }
+
+    static const char *getTypeName(double)
+    {
+        return "double";
+    }
+
+    /**
+     * getLanguageFlag: The generated code is built in the same language
+     * mode as this file, so calls like pow(float,int) resolve the same way
+     */
+    static const char *getLanguageFlag()
+    {
+#if __cplusplus >= 201703L
+        return "-std=gnu++17";
+#elif __cplusplus >= 201402L
+        return "-std=gnu++14";
+#elif __cplusplus >= 201103L
+        return "-std=gnu++11";
+#else
+        return "-std=gnu++98";
+#endif
+    }
+
+    /**
+     * writeConstant: Writes value so it reads back as exactly the same Type
+     */
+    template<class Type>
+    static void writeConstant(ostream &out,Type value)
+    {
+        if (value!=value)
+        {
+            out << "numeric_limits<Type>::quiet_NaN()";
+        }
+        else if (value==numeric_limits<Type>::infinity())
+        {
+            out << "numeric_limits<Type>::infinity()";
+        }
+        else if (value==-numeric_limits<Type>::infinity())
+        {
+            out << "-numeric_limits<Type>::infinity()";
+        }
+        else
+        {
+            //A float widens to double exactly, so 17 digits round trip both
+            out << "Type(" << setprecision(17) << showpoint << double(value) << ")";
+        }
+    }
+
+    template<class Type>
+    CompiledNetwork<Type>::~CompiledNetwork()
+    {
+#ifdef NEAT_HAVE_DLOPEN
+        if (library)
+        {
+            dlclose(library);
+        }
+#endif
+    }
+
+    static boost::mutex singletonMutex;
+
+    template<class Type>
+    NetworkCompiler<Type> *NetworkCompiler<Type>::singleton = NULL;
+
+    template<class Type>
+    NetworkCompiler<Type> *NetworkCompiler<Type>::getSingleton()
+    {
+        boost::mutex::scoped_lock lock(singletonMutex);
+
+        if (!singleton)
+        {
+            singleton = new NetworkCompiler<Type>();
+        }
+
+        return singleton;
+    }
+
+    template<class Type>
+    void NetworkCompiler<Type>::deinit()
+    {
+        boost::mutex::scoped_lock lock(singletonMutex);
+
+        if (singleton)
+        {
+            delete singleton;
+            singleton = NULL;
+        }
+    }
+
+    template<class Type>
+    NetworkCompiler<Type>::NetworkCompiler()
+        :
+    compiling(0),
+        worker(NULL),
+        stopping(false),
+        disabled(true),
+        numCompiled(0)
+    {
+#ifdef NEAT_HAVE_DLOPEN
+        const char *tempDirectory = getenv("TMPDIR");
+        ostringstream directoryName;
+        directoryName << "neat_networks_" << getpid() << '_' << sizeof(Type);
+
+        try
+        {
+            boost::filesystem::path directory(tempDirectory ? tempDirectory : "/tmp");
+            directory /= directoryName.str();
+            boost::filesystem::create_directories(directory);
+            workingDirectory = directory.string();
+            disabled = false;
+        }
+        catch (const boost::filesystem::filesystem_error &error)
+        {
+            cout << "Could not create a directory for compiled networks: " << error.what() << endl;
+        }
+
+        if (!disabled)
+        {
+            worker = new boost::thread(boost::bind(&NetworkCompiler<Type>::compileLoop,this));
+        }
+#endif
+    }
+
+    template<class Type>
+    NetworkCompiler<Type>::~NetworkCompiler()
+    {
+        {
+            boost::mutex::scoped_lock lock(entriesMutex);
+            stopping = true;
+            pendingCondition.notify_all();
+        }
+
+        if (worker)
+        {
+            worker->join();
+            delete worker;
+        }
+
+#ifdef NEAT_HAVE_DLOPEN
+        if (workingDirectory.length())
+        {
+            try
+            {
+                boost::filesystem::remove_all(workingDirectory);
+            }
+            catch (const boost::filesystem::filesystem_error &)
+            {
+            }
+        }
+#endif
+    }
+
+    template<class Type>
+    string NetworkCompiler<Type>::getSignature(
+        const FastNetwork<Type> &network,
+        bool signedActivation,
+        bool usingTanhSigmoid
+        )
+    {
+        const IncomingLinkTable<Type> &incomingLinks = network.incomingLinks;
+
+        string signature;
+        signature.reserve(64 + network.numNodes*8 + network.numLinks*(4+sizeof(Type)));
+
+        appendBytes(signature,sizeof(Type));
+        appendBytes(signature,signedActivation);
+        appendBytes(signature,usingTanhSigmoid);
+        appendBytes(signature,network.numNodes);
+        appendBytes(signature,network.numConstantNodes);
+        appendBytes(signature,network.feedForward);
+        appendBytes(signature,network.feedForwardDepth);
+
+        for (int a=network.numConstantNodes;a<network.numNodes;a++)
+        {
+            appendBytes(signature,network.activationFunctions[a]);
+            appendBytes(signature,incomingLinks.getRowEnd(a));
+            for (int b=incomingLinks.getRowStart(a);b<incomingLinks.getRowEnd(a);b++)
+            {
+                appendBytes(signature,incomingLinks.getFromNode(b));
+                appendBytes(signature,incomingLinks.getWeight(b));
+            }
+        }
+
+        return signature;
+    }
+
+    template<class Type>
+    void NetworkCompiler<Type>::writeUpdate(
+        ostream &out,
+        const FastNetwork<Type> &network,
+        bool signedActivation,
+        bool usingTanhSigmoid,
+        const string &stride,
+        const string &indent
+        )
+    {
+        const IncomingLinkTable<Type> &incomingLinks = network.incomingLinks;
+
+        //Each node's activated sum, written as an expression of values[].  Nodes
+        //with no inputs are the same on every update, so they become constants.
+        vector<string> nodeExpressions(network.numNodes);
+        for (int a=network.numConstantNodes;a<network.numNodes;a++)
+        {
+            ostringstream expression;
+
+            if (incomingLinks.getRowStart(a)==incomingLinks.getRowEnd(a))
+            {
+                Type zero(0),value;
+                runActivationKernel(
+                    network.activationFunctions[a],
+                    (const int*)NULL,
+                    1,
+                    &zero,
+                    &value,
+                    signedActivation,
+                    usingTanhSigmoid,
+                    ACTIVATION_ACCURACY_EXACT
+                    );
+                writeConstant(expression,value);
+            }
+            else
+            {
+                //Same order as IncomingLinkTable::sum
+                expression << getActivationName(network.activationFunctions[a],signedActivation,usingTanhSigmoid);
+                expression << "(Type(0)";
+                for (int b=incomingLinks.getRowStart(a);b<incomingLinks.getRowEnd(a);b++)
+                {
+                    expression << " + values[" << incomingLinks.getFromNode(b) << stride << "]*";
+                    writeConstant(expression,incomingLinks.getWeight(b));
+                }
+                expression << ",signedSigmoidTable,unsignedSigmoidTable)";
+            }
+
+            nodeExpressions[a] = expression.str();
+        }
+
+        string loopIndent = indent;
+        if (network.feedForward)
+        {
+            out << indent << "if (count>=" << network.feedForwardDepth << ")\n";
+            out << indent << "{\n";
+            for (int a=0;a<(int)network.feedForwardNodes.size();a++)
+            {
+                int node = network.feedForwardNodes[a];
+                out << indent << "    values[" << node << stride << "] = " << nodeExpressions[node] << ";\n";
+            }
+            out << indent << "}\n";
+            out << indent << "else\n";
+            out << indent << "{\n";
+            loopIndent += "    ";
+        }
+
+        out << loopIndent << "for (int iteration=0;iteration<count;iteration++)\n";
+        out << loopIndent << "{\n";
+        for (int a=network.numConstantNodes;a<network.numNodes;a++)
+        {
+            out << loopIndent << "    Type newValue" << a << " = " << nodeExpressions[a] << ";\n";
+        }
+        for (int a=network.numConstantNodes;a<network.numNodes;a++)
+        {
+            out << loopIndent << "    values[" << a << stride << "] = newValue" << a << ";\n";
+        }
+        out << loopIndent << "}\n";
+
+        if (network.feedForward)
+        {
+            out << indent << "}\n";
+        }
+    }
+
+    template<class Type>
+    string NetworkCompiler<Type>::generateSource(
+        const FastNetwork<Type> &network,
+        bool signedActivation,
+        bool usingTanhSigmoid
+        )
+    {
+        ostringstream out;
+
+        out << "#include <cmath>\n";
+        out << "#include <algorithm>\n";
+        out << "#include <limits>\n";
+        out << "using namespace std;\n";
+        out << "typedef " << getTypeName(Type()) << " Type;\n";
+        out << activationSource;
+
+        out << "extern \"C\" void neatUpdateNetwork(Type *values,int count,"
+            << "const double *signedSigmoidTable,const double *unsignedSigmoidTable)\n";
+        out << "{\n";
+        writeUpdate(out,network,signedActivation,usingTanhSigmoid,"","    ");
+        out << "}\n";
+
+        //The samples don't depend on each other, so each one runs the same
+        //updates on its own column of batchValues
+        out << "extern \"C\" void neatUpdateNetworkBatch(Type *batchValues,int numSamples,int count,"
+            << "const double *signedSigmoidTable,const double *unsignedSigmoidTable)\n";
+        out << "{\n";
+        out << "    for (int sample=0;sample<numSamples;sample++)\n";
+        out << "    {\n";
+        out << "        Type *values = batchValues+sample;\n";
+        writeUpdate(out,network,signedActivation,usingTanhSigmoid,"*numSamples","        ");
+        out << "    }\n";
+        out << "}\n";
+
+        return out.str();
+    }
+
+    template<class Type>
+    void NetworkCompiler<Type>::attach(FastNetwork<Type> &network)
+    {
+#ifdef NEAT_HAVE_DLOPEN
+        int threshold = Globals::getSingleton()->getNetworkCompileThreshold();
+        bool signedActivation = Globals::getSingleton()->hasSignedActivation();
+        bool usingTanhSigmoid = Globals::getSingleton()->isUsingTanhSigmoid();
+
+        //The compiled code only reproduces the exact activation functions
+        if (threshold<=0 || Globals::getSingleton()->getActivationAccuracy()!=ACTIVATION_ACCURACY_EXACT)
+        {
+            return;
+        }
+
+        network.refreshIncomingLinks();
+
+        string signature = getSignature(network,signedActivation,usingTanhSigmoid);
+        unsigned long long hash = hashSignature(signature);
+
+        boost::mutex::scoped_lock lock(entriesMutex);
+
+        Entry &entry = entries[hash];
+
+        if (entry.state==ENTRY_READY)
+        {
+            //Two genomes with the same hash can't share code
+            if (entry.signature==signature)
+            {
+                network.compiled = entry.compiled;
+            }
+            return;
+        }
+
+        if (entry.state!=ENTRY_COUNTING || disabled)
+        {
+            return;
+        }
+
+        entry.spawns++;
+        if (entry.spawns<threshold)
+        {
+            return;
+        }
+
+        entry.state = ENTRY_PENDING;
+        entry.signature.swap(signature);
+        entry.compiled.reset(new CompiledNetwork<Type>());
+        entry.compiled->signedActivation = signedActivation;
+        entry.compiled->usingTanhSigmoid = usingTanhSigmoid;
+
+        //Nobody else touches a pending entry until it is queued, so the
+        //source can be generated without holding up other threads
+        lock.unlock();
+        string source = generateSource(network,signedActivation,usingTanhSigmoid);
+        lock.lock();
+
+        entry.source.swap(source);
+        pending.push_back(hash);
+        pendingCondition.notify_one();
+#endif
+    }
+
+    template<class Type>
+    void NetworkCompiler<Type>::waitForPending()
+    {
+        boost::mutex::scoped_lock lock(entriesMutex);
+
+        while (pending.size() || compiling)
+        {
+            idleCondition.wait(lock);
+        }
+    }
+
+    template<class Type>
+    int NetworkCompiler<Type>::getNumCompiled()
+    {
+        boost::mutex::scoped_lock lock(entriesMutex);
+
+        return numCompiled;
+    }
+
+    template<class Type>
+    void NetworkCompiler<Type>::compileLoop()
+    {
+        while (true)
+        {
+            unsigned long long hash;
+            Entry *entry;
+
+            {
+                boost::mutex::scoped_lock lock(entriesMutex);
+
+                while (pending.empty() && !stopping)
+                {
+                    pendingCondition.wait(lock);
+                }
+
+                if (stopping)
+                {
+                    return;
+                }
+
+                hash = pending.front();
+                pending.pop_front();
+                entry = &entries[hash];
+                compiling++;
+            }
+
+            bool success = compile(hash,*entry);
+
+            {
+                boost::mutex::scoped_lock lock(entriesMutex);
+
+                compiling--;
+
+                if (success)
+                {
+                    entry->state = ENTRY_READY;
+                    numCompiled++;
+                }
+                else
+                {
+                    entry->state = ENTRY_FAILED;
+
+                    //Whatever broke this build will break the rest too
+                    disabled = true;
+                    while (pending.size())
+                    {
+                        entries[pending.front()].state = ENTRY_FAILED;
+                        pending.pop_front();
+                    }
+                }
+
+                idleCondition.notify_all();
+            }
+        }
+    }
+
+    template<class Type>
+    bool NetworkCompiler<Type>::compile(unsigned long long hash,Entry &entry)
+    {
+#ifdef NEAT_HAVE_DLOPEN
+        ostringstream baseName;
+        baseName << workingDirectory << "/network_" << hex << setw(16) << setfill('0') << hash;
+        string sourceFile = baseName.str() + ".cpp";
+        string libraryFile = baseName.str() + ".so";
+        string logFile = baseName.str() + ".log";
+
+        {
+            ofstream sourceStream(sourceFile.c_str());
+            sourceStream << entry.source;
+            if (!sourceStream)
+            {
+                cout << "Could not write " << sourceFile << endl;
+                return false;
+            }
+        }
+        string().swap(entry.source);
+
+        const char *compilerName = getenv("NEAT_CXX");
+
+        string command =
+            string(compilerName ? compilerName : "c++") + " " + getLanguageFlag() +
+            " -O2 -fPIC -shared -ffp-contract=off -w -o \"" + libraryFile + "\" \"" +
+            sourceFile + "\" > \"" + logFile + "\" 2>&1";
+
+        if (::system(command.c_str()))
+        {
+            cout << "Compiling networks failed, falling back to the interpreter.  See " << logFile << endl;
+            return false;
+        }
+
+        void *library = dlopen(libraryFile.c_str(),RTLD_NOW|RTLD_LOCAL);
+        if (!library)
+        {
+            cout << "Could not load a compiled network: " << dlerror() << endl;
+            return false;
+        }
+
+        void *symbol = dlsym(library,"neatUpdateNetwork");
+        if (!symbol)
+        {
+            cout << "Could not find the update in a compiled network: " << dlerror() << endl;
+            dlclose(library);
+            return false;
+        }
+
+        void *batchSymbol = dlsym(library,"neatUpdateNetworkBatch");
+        if (!batchSymbol)
+        {
+            cout << "Could not find the batch update in a compiled network: " << dlerror() << endl;
+            dlclose(library);
+            return false;
+        }
+
+        entry.compiled->library = library;
+        *(void**)(&entry.compiled->update) = symbol;
+        *(void**)(&entry.compiled->updateBatch) = batchSymbol;
+
+        //The library stays mapped after its file is gone
+        remove(sourceFile.c_str());
+        remove(libraryFile.c_str());
+        remove(logFile.c_str());
+
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    template class CompiledNetwork<float>; // explicit instantiation
+    template class CompiledNetwork<double>; // explicit instantiation
+
+    template class NetworkCompiler<float>; // explicit instantiation
+    template class NetworkCompiler<double>; // explicit instantiation
+}
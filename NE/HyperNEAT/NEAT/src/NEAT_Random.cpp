@@ -8,21 +8,112 @@
 
 namespace NEAT
 {
+    //The Philox4x32 multipliers and Weyl key increments
+    static const unsigned long long PHILOX_M0 = 0xD2511F53ULL;
+    static const unsigned long long PHILOX_M1 = 0xCD9E8D57ULL;
+    static const unsigned int PHILOX_W0 = 0x9E3779B9U;
+    static const unsigned int PHILOX_W1 = 0xBB67AE85U;
+
+    //Blocks made side by side in makeBlocks(), which is what vectorizes
+    static const int BLOCK_BATCH = 16;
+
+    //53 random bits scaled to [0,1-1e-6), the range the doubles have always had
+    static const double DOUBLE_SCALE = (1.0-1e-6)/9007199254740992.0;
+
+    static inline double makeDouble(unsigned int lowWord,unsigned int highWord)
+    {
+        unsigned long long bits = ((((unsigned long long)highWord)<<32) | lowWord)>>11;
+        return double(bits)*DOUBLE_SCALE;
+    }
+
     Random::Random(unsigned int _seed)
             :
             seed(_seed?_seed:static_cast<unsigned int>( ( (std::time(0)&0x0FFF)<<16) + (std::time(0)%0xFFFF) )),
-            generator(seed),
-            intDist(0,INT_MAX/2),
-            intGen(generator,intDist),
-            realDist(0,1.0 - 1e-6),
-            realGen(generator,realDist),
-            normalDist(0,1.0 - 1e-6),
-            normalGen(generator,normalDist)
-    {}
+            counter(0),
+            blockPosition(BLOCK_SIZE)
+    {
+        key[0] = seed;
+        key[1] = 0;
+    }
+
+    void Random::makeBlocks(
+        const unsigned int key[2],
+        unsigned long long firstCounter,
+        unsigned int counterHigh,
+        unsigned int counterTop,
+        int numBlocks,
+        unsigned int *blocks
+    )
+    {
+        unsigned int c0[BLOCK_BATCH],c1[BLOCK_BATCH],c2[BLOCK_BATCH],c3[BLOCK_BATCH];
+
+        for (int base=0;base<numBlocks;base+=BLOCK_BATCH)
+        {
+            for (int a=0;a<BLOCK_BATCH;a++)
+            {
+                unsigned long long blockCounter = firstCounter+base+a;
+                c0[a] = (unsigned int)blockCounter;
+                c1[a] = (unsigned int)(blockCounter>>32);
+                c2[a] = counterHigh;
+                c3[a] = counterTop;
+            }
+
+            unsigned int k0 = key[0],k1 = key[1];
+            for (int round=0;round<10;round++)
+            {
+                //The blocks don't depend on each other, so this loop is
+                //done in vector registers
+                for (int a=0;a<BLOCK_BATCH;a++)
+                {
+                    unsigned long long product0 = PHILOX_M0*c0[a];
+                    unsigned long long product1 = PHILOX_M1*c2[a];
+
+                    unsigned int n0 = ((unsigned int)(product1>>32))^c1[a]^k0;
+                    unsigned int n2 = ((unsigned int)(product0>>32))^c3[a]^k1;
+                    c1[a] = (unsigned int)product1;
+                    c3[a] = (unsigned int)product0;
+                    c0[a] = n0;
+                    c2[a] = n2;
+                }
+
+                k0 += PHILOX_W0;
+                k1 += PHILOX_W1;
+            }
+
+            int batchBlocks = min(BLOCK_BATCH,numBlocks-base);
+            for (int a=0;a<batchBlocks;a++)
+            {
+                unsigned int *outBlock = blocks+size_t(base+a)*BLOCK_SIZE;
+                outBlock[0] = c0[a];
+                outBlock[1] = c1[a];
+                outBlock[2] = c2[a];
+                outBlock[3] = c3[a];
+            }
+        }
+    }
+
+    Random Random::getStream(unsigned int streamA,unsigned int streamB) const
+    {
+        //Draws only ever use counters with zero high words
+        unsigned int streamBlock[BLOCK_SIZE];
+        makeBlocks(
+            key,
+            (((unsigned long long)streamB)<<32) | streamA,
+            0xFFFFFFFFU,
+            0xFFFFFFFFU,
+            1,
+            streamBlock
+        );
+
+        Random stream(seed);
+        stream.key[0] = streamBlock[0];
+        stream.key[1] = streamBlock[1];
+        return stream;
+    }
 
     int Random::getRandomInt(int limit)
     {
-        int randNum = intGen()%limit;
+        int randNum = int((((unsigned long long)getRandomWord())*(unsigned int)limit)>>32);
 
 #if DEBUG_RANDOM
         if(randNum<0 || randNum>=limit)
@@ -36,7 +127,8 @@ namespace NEAT
 
     int Random::getRandomWithinRange(int min,int max)
     {
-        int randNum = min + (intGen()%( (max-min) + 1));
+        unsigned long long range = (unsigned long long)(max-min)+1;
+        int randNum = min + int((getRandomWord()*range)>>32);
 
 #if DEBUG_RANDOM
         if(randNum<min || randNum>max)
@@ -50,7 +142,8 @@ namespace NEAT
 
     double Random::getRandomDouble()
     {
-        double randNum = realGen();
+        unsigned int lowWord = getRandomWord();
+        double randNum = makeDouble(lowWord,getRandomWord());
 
 #if DEBUG_RANDOM
         if(randNum<0.0 || randNum>=1.0)
@@ -59,12 +152,12 @@ namespace NEAT
         }
 #endif
 
-        return realGen();
+        return randNum;
     }
 
     double Random::getRandomDouble(double low,double high)
     {
-        double randNum = realGen()*(high-low) + low;
+        double randNum = getRandomDouble()*(high-low) + low;
 
 #if DEBUG_RANDOM
         if(randNum<low || randNum>=high)
@@ -75,4 +168,21 @@ namespace NEAT
 
         return randNum;
     }
+
+    void Random::getRandomDoubles(double *values,int count)
+    {
+        //Two words per double, so two doubles per block
+        int numBlocks = (count+1)/2;
+        vector<unsigned int> blocks(size_t(numBlocks)*BLOCK_SIZE);
+        if (numBlocks)
+        {
+            makeBlocks(key,counter,0,0,numBlocks,&blocks[0]);
+            counter += numBlocks;
+        }
+
+        for (int a=0;a<count;a++)
+        {
+            values[a] = makeDouble(blocks[a*2],blocks[a*2+1]);
+        }
+    }
 }
@@ -0,0 +1,26 @@
+#include "NEAT_Defines.h"
+
+#include "NEAT_StringTable.h"
+
+#include <set>
+
+namespace NEAT
+{
+    //A set never moves its elements, so the pointers stay good
+    static std::set<string> internedStrings;
+    static boost::mutex internedStringsMutex;
+
+    const string *StringTable::intern(const string &value)
+    {
+        boost::mutex::scoped_lock scoped_lock(internedStringsMutex);
+
+        return &*internedStrings.insert(value).first;
+    }
+
+    int StringTable::getNumStrings()
+    {
+        boost::mutex::scoped_lock scoped_lock(internedStringsMutex);
+
+        return (int)internedStrings.size();
+    }
+}
@@ -0,0 +1,161 @@
+#include "NEAT_Defines.h"
+
+#include "NEAT_SubstrateCache.h"
+
+#include "NEAT_Globals.h"
+
+#include "NEAT_Signature.h"
+
+namespace NEAT
+{
+    static boost::mutex singletonMutex;
+
+    template<class Type>
+    SubstrateCache<Type> *SubstrateCache<Type>::singleton = NULL;
+
+    template<class Type>
+    SubstrateCache<Type> *SubstrateCache<Type>::getSingleton()
+    {
+        boost::mutex::scoped_lock lock(singletonMutex);
+
+        if (!singleton)
+        {
+            singleton = new SubstrateCache<Type>();
+        }
+
+        return singleton;
+    }
+
+    template<class Type>
+    void SubstrateCache<Type>::deinit()
+    {
+        boost::mutex::scoped_lock lock(singletonMutex);
+
+        if (singleton)
+        {
+            delete singleton;
+            singleton = NULL;
+        }
+    }
+
+    template<class Type>
+    SubstrateCache<Type>::SubstrateCache()
+        :
+    hits(0),
+        misses(0)
+    {
+    }
+
+    template<class Type>
+    SubstrateCache<Type>::~SubstrateCache()
+    {
+    }
+
+    template<class Type>
+    bool SubstrateCache<Type>::find(const string &signature,FastLayeredNetwork<Type> &network)
+    {
+        unsigned long long hash = hashSignature(signature);
+        shared_ptr<const FastLayeredNetwork<Type> > cachedNetwork;
+
+        {
+            boost::mutex::scoped_lock lock(entriesMutex);
+
+            typename map<unsigned long long,Entry>::iterator entry = entries.find(hash);
+
+            //Two substrates with the same hash can't share a network
+            if (entry==entries.end() || entry->second.signature!=signature)
+            {
+                misses++;
+                return false;
+            }
+
+            hits++;
+            lru.splice(lru.begin(),lru,entry->second.lruPosition);
+            cachedNetwork = entry->second.network;
+        }
+
+        //The cached network is never changed, so it's copied without the lock
+        network = *cachedNetwork;
+        return true;
+    }
+
+    template<class Type>
+    void SubstrateCache<Type>::insert(const string &signature,const FastLayeredNetwork<Type> &network)
+    {
+        int capacity = Globals::getSingleton()->getSubstrateCacheSize();
+        if (capacity<=0)
+        {
+            return;
+        }
+
+        unsigned long long hash = hashSignature(signature);
+        shared_ptr<const FastLayeredNetwork<Type> > cachedNetwork(new FastLayeredNetwork<Type>(network));
+
+        boost::mutex::scoped_lock lock(entriesMutex);
+
+        typename map<unsigned long long,Entry>::iterator entry = entries.find(hash);
+        if (entry==entries.end())
+        {
+            lru.push_front(hash);
+            entry = entries.insert(pair<unsigned long long,Entry>(hash,Entry())).first;
+            entry->second.lruPosition = lru.begin();
+        }
+        else
+        {
+            lru.splice(lru.begin(),lru,entry->second.lruPosition);
+        }
+
+        entry->second.signature = signature;
+        entry->second.network = cachedNetwork;
+
+        trim(capacity);
+    }
+
+    template<class Type>
+    void SubstrateCache<Type>::trim(int capacity)
+    {
+        while ((int)entries.size()>capacity)
+        {
+            entries.erase(lru.back());
+            lru.pop_back();
+        }
+    }
+
+    template<class Type>
+    void SubstrateCache<Type>::clear()
+    {
+        boost::mutex::scoped_lock lock(entriesMutex);
+
+        entries.clear();
+        lru.clear();
+        hits=0;
+        misses=0;
+    }
+
+    template<class Type>
+    int SubstrateCache<Type>::getHits()
+    {
+        boost::mutex::scoped_lock lock(entriesMutex);
+
+        return hits;
+    }
+
+    template<class Type>
+    int SubstrateCache<Type>::getMisses()
+    {
+        boost::mutex::scoped_lock lock(entriesMutex);
+
+        return misses;
+    }
+
+    template<class Type>
+    int SubstrateCache<Type>::getNumEntries()
+    {
+        boost::mutex::scoped_lock lock(entriesMutex);
+
+        return (int)entries.size();
+    }
+
+    template class SubstrateCache<float>; // explicit instantiation
+    template class SubstrateCache<double>; // explicit instantiation
+}
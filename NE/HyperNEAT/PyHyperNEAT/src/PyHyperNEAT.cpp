@@ -56,6 +56,10 @@ void initializeHyperNEAT()
 
 void cleanupHyperNEAT()
 {
+	NEAT::SubstrateCache<float>::deinit();
+	NEAT::SubstrateCache<double>::deinit();
+	NEAT::NetworkCompiler<float>::deinit();
+	NEAT::NetworkCompiler<double>::deinit();
 	NEAT::Globals::deinit();
 }
 